@@ -17,6 +17,12 @@ extern pcb_PTR outBlocked (pcb_PTR p);
 extern pcb_PTR headBlocked (int *semAdd);
 extern void initASL ();
 
+extern pcb_PTR semOwner (int *semAdd);
+extern int setSemOwner (int *semAdd, pcb_PTR p);
+extern void clearSemOwner (int *semAdd);
+extern void releaseOwned (pcb_PTR p);
+extern int ownedCeiling (pcb_PTR p);
+
 /***************************************************************/
 
 #endif
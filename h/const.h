@@ -10,8 +10,13 @@
 /* Hardware & software constants */
 #define PAGESIZE		  4096			/* page size in bytes	*/
 #define WORDLEN			  4				/* word size in bytes	*/
-#define MAXPROC			  20			/* max number of processes */
+#define MAXPROC			  20			/* PCBs in the static slab */
+#define MAXPCBS			  200			/* max number of processes, all slabs */
+#ifndef MAXSEMD
+#define MAXSEMD			  (2 * MAXPCBS)	/* semaphore descriptors in the ASL */
+#endif
 #define MAXSTRLEN		  128			/* max string length	*/
+#define ASLHASHSIZE		  POW2CEIL(MAXSEMD / 2)	/* ASL hash buckets, load <= 2 */
 
 /* timer, timescale, TOD-LO and other bus regs */
 #define RAMBASEADDR		0x10000000
@@ -107,15 +112,40 @@
 #define MAX(A,B)		((A) < (B) ? B : A)
 #define	ALIGNED(A)		(((unsigned)A & 0x3) == 0)
 
+/* Smallest power of 2 >= N (N >= 1): copy the top bit of N - 1 into every
+ * lower bit, then add one. A constant expression, so it can size arrays */
+#define SMEAR2(X)		((X) | ((X) >> 1))
+#define SMEAR4(X)		(SMEAR2(X) | (SMEAR2(X) >> 2))
+#define SMEAR8(X)		(SMEAR4(X) | (SMEAR4(X) >> 4))
+#define SMEAR16(X)		(SMEAR8(X) | (SMEAR8(X) >> 8))
+#define SMEAR32(X)		(SMEAR16(X) | (SMEAR16(X) >> 16))
+#define POW2CEIL(N)		(SMEAR32((unsigned) (N) - 1) + 1)
+
 /* Macro to load the Interval Timer */
 #define LDIT(T)	((* ((cpu_t *) INTERVALTMR)) = (T) * (* ((cpu_t *) TIMESCALEADDR))) 
 
+/* Park the interval timer as far in the future as it goes */
+#define PARKIT()	((* ((cpu_t *) INTERVALTMR)) = XLVALUE)
+
 /* Macro to read the TOD clock */
 #define STCK(T) ((T) = ((* ((cpu_t *) TODLOADDR)) / (* ((cpu_t *) TIMESCALEADDR))))
 #define RAMTOP(T) ((T) = ((* ((int *) RAMBASEADDR)) + (* ((int *) RAMBASESIZE))))
 
 /* Timing constants */
 #define QUANTUM         5000      /* 5ms in microseconds */
+#define MINQUANTUM      1000      /* shortest adaptive quantum (1ms) */
+#define MAXQUANTUM      20000     /* longest adaptive quantum (20ms) */
+#define MAXSLICE        40000     /* longest slice at any level (40ms), the 
+                                     bottom level slice of a QUANTUM */
+#define STRIDE1         (1 << 12) /* stride of a process holding one ticket */
+#define MAXTICKETS      256       /* most tickets a process can hold */
+#define STRIDEUNIT      100       /* usecs of CPU charged one stride */
+#define MLFQTICKETS     64        /* tickets of the MLFQ class as a whole */
+#define UTILSCALE       1000      /* real-time utilization of a full CPU */
+#define MAXPERIOD       4000000   /* longest real-time period (4s), keeps
+                                     budget * UTILSCALE within 32 bits */
+#define MLFQLEVELS      4         /* ready queue levels, 0 is the highest */
+#define AGINGTICKS      10        /* pseudo-clock intervals between boosts (1s) */
 #define CLOCKINTERVAL   100000UL    /* 100ms in microseconds */
 
 /* system call codes */
@@ -137,6 +167,33 @@
 #define FLASHPUT        16
 #define FLASHGET        17
 #define DELAY           18
+#define PSEMVIRT        19
+#define VSEMVIRT        20
+
+/* nucleus system call codes past the support level ones; U-procs
+   reach them through the support level */
+#define SETPRIORITY     21
+#define GETPRIORITY     22
+#define GETSCHEDINFO    23
+#define SETTICKETS      24
+#define SETREALTIME     25
+#define SETHANDOFF      26
+
+/* support level system call past the nucleus ones */
+#define GETPAGEFAULTS   27
+
+/* values selected by GETPAGEFAULTS in a1 */
+#define FAULTSHARD      0         /* page faults that read flash */
+#define FAULTSSOFT      1         /* page faults served without I/O */
+#define FAULTSPAGEOUTS  2         /* pages written back to serve them */
+#define FAULTSDIRTY     3         /* first writes to clean pages */
+
+/* values selected by GETSCHEDINFO in a1 */
+#define SCHEDQUANTUM    0         /* current quantum at level 0 */
+#define SCHEDYIELDS     1         /* voluntary context switches */
+#define SCHEDPREEMPTS   2         /* involuntary context switches */
+#define SCHEDJOBS       3         /* real-time jobs released */
+#define SCHEDMISSES     4         /* real-time deadlines missed */
 
 /*Line Constants*/
 #define PROCESSOR       0
@@ -153,6 +210,7 @@
 #define DEVICE_COUNT        49
 #define DEV_PER_INT         8
 #define CLOCK           DEVICE_COUNT - 1
+#define DEVWORKMAX      (DEVICE_COUNT - 1)  /* deferred completions, one per (sub)device */
 
 /************************************/
 
@@ -171,6 +229,7 @@
 #define RICODE 0xFFFFFF28
 #define TEXTAREAADDR 0x800000B0
 #define STACKPAGEADDR 0xC0000000
+#define KINFOPAGE 0xA0000000  /* where U-procs see the kernel info page */
 
 /* Memory Management Registers */
 #define ASIDMASK       0x00000FC0    /* ASID field mask */
@@ -178,6 +237,7 @@
 #define PTEMAGICNO     0x2A          /* Page Table Entry magic number */
 #define VPNMASK        0xFFFFF000    /* Mask for VPN */
 #define ENTRYHIMASK    0xFFFFF000    /* Mask for EntryHI */
+#define PFNMASK        0xFFFFF000    /* Mask for the frame address in EntryLO */
 
 /* Exception State Areas */
 #define SYSCALL_NEWAREA   0x20001000    /* Syscall new area */
@@ -237,6 +297,8 @@
 
 /* Miscellaneous */
 #define UPROCMAX       8            /* Maximum number of user processes */
+#define VIRTSEMCOUNT   16           /* semaphores shared by U-procs (SYS19/20) */
+#define HANDOFFMAX     16           /* semaphores that hand off on V (SYS26) */
 #define BITMASK_8      0xFF
 #define INDEX_PMASK 0x80000000
 #define BITSHIFT_8     8
@@ -253,6 +315,7 @@
 #define VPNSHIFT 12             /* shift value */
 #define VALIDON 0x00000200   /* valid bit */
 #define DIRTYON 0x00000400   /* dirty bit */
+#define GLOBALON 0x00000100  /* global bit: the entry matches every ASID */
 #define VALIDOFF 0xFFFFFDFF     /* valid bit cleared mask */
 #define ASIDSHIFT 6          /* shift value for ASID */
 #define UPROCSTART 0x80000
@@ -269,5 +332,9 @@
 #define POOLBASEADDR 0x20020000     /* base address of swap pool */
 #define DISKPOOLSTART    (POOLBASEADDR + (POOLSIZE * PAGESIZE))
 #define FLASHPOOLSTART   (DISKPOOLSTART + (DEVPERINT * PAGESIZE))
+#define KINFOFRAME       (FLASHPOOLSTART + (DEVPERINT * PAGESIZE))  /* RAM page of the kernel info page */
+#define PCBSLABSTART     (KINFOFRAME + PAGESIZE)  /* RAM pages for PCB slabs */
+#define PCBSLABMAX       10     /* max RAM pages carved into PCB slabs */
+#define PCBSLABRESERVE   (2 * FRAMESIZE)  /* stacks of test & delay daemon below RAMTOP */
 
 #endif
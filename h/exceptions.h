@@ -29,13 +29,19 @@ extern void uTLB_RefillHandler();
 
 /* System Calls */
 void createProcess();
-void terminateProcess(pcb_PTR current);
+void terminateProcess(pcb_PTR root);
 void passeren();
 void verhogen();
 void waitIO();
 void getCPUTime();
 void waitClock();
 void getSupportData();
+void setPriority();
+void getPriority();
+void getSchedInfo();
+void setTickets();
+void setRealTime();
+void setHandoff();
 
 /* Support Functions */
 void copyState(state_t *source, state_t *dest);
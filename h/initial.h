@@ -14,9 +14,10 @@ extern void test();
 
 extern int processCount;            
 extern int softBlockCount;                 
-extern pcb_PTR readyQueue;               
+extern pcb_PTR readyQueues[MLFQLEVELS];               
 extern pcb_PTR currentProcess;          
 extern int deviceSemaphores[DEVICE_COUNT];  
+extern pcb_PTR deviceQueues[DEVICE_COUNT];
 extern cpu_t TOD_start;
 
 #endif
\ No newline at end of file
@@ -21,6 +21,13 @@ extern void interruptHandler(state_PTR exceptionsState);
 extern void itInterrupt();
 extern void pltInterrupt();
 extern void nonTimerInterrupt(devregarea_t *devRegA, int lineNo);
+extern void runDeferredWork();
+extern void startClock();
+extern void armClock();
+extern void waitForTick(pcb_PTR p);
+extern void settleTickWaiter(pcb_PTR p);
+extern pcb_PTR outTickWaiter(pcb_PTR p);
+extern unsigned int clockTicks(cpu_t now);
 /*******************************************************************/
 
 #endif
@@ -18,9 +18,12 @@ extern void initPcbs ();
 extern pcb_PTR mkEmptyProcQ ();
 extern int emptyProcQ (pcb_PTR tp);
 extern void insertProcQ (pcb_PTR *tp, pcb_PTR p);
+extern void insertHeadProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR removeProcQ (pcb_PTR *tp);
 extern pcb_PTR outProcQ (pcb_PTR *tp, pcb_PTR p);
 extern pcb_PTR headProcQ (pcb_PTR tp);
+extern void joinProcQ (pcb_PTR *dest, pcb_PTR *src);
+extern int spliceProcQ (pcb_PTR *dest, pcb_PTR *src);
 
 extern int emptyChild (pcb_PTR p);
 extern void insertChild (pcb_PTR prnt, pcb_PTR p);
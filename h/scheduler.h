@@ -14,10 +14,30 @@
 #include "../h/pcb.h"
 #include "../h/initial.h"
 
-/* A simple round-robin scheduler*/
+/* A multi-level feedback queue scheduler */
 extern void scheduler();
+extern void readyProcess(pcb_PTR p);
+extern void readyProcessFront(pcb_PTR p);
+extern pcb_PTR outReady(pcb_PTR p);
+extern void promoteProcess(pcb_PTR p);
+extern void demoteProcess(pcb_PTR p);
+extern void ageProcesses();
+extern int quantumBlocked(pcb_PTR p);
+extern void quantumExpired(pcb_PTR p);
+extern int changeTickets(pcb_PTR p, int tickets);
+extern int changeRealTime(pcb_PTR p, cpu_t period, cpu_t budget);
+extern void leaveRealTime(pcb_PTR p);
+extern int releaseJobs();
+extern void armTimer();
+extern int sliceExpired();
+extern void slicePreempted(pcb_PTR p);
+extern void sliceHandedOff(cpu_t now);
+extern int realTimePending(pcb_PTR p);
+extern int higherLevelPending(pcb_PTR p);
+extern int effectivePrio(pcb_PTR p);
+extern void inheritPrio(pcb_PTR p, int prio);
 
-extern void loadNextState(state_t state);
+extern void loadNextState(state_PTR state);
 extern void copyState(state_t *source, state_t *dest);
 
 /***************************************************************/
@@ -15,7 +15,7 @@
 #include "/usr/include/umps3/umps/libumps.h"
 
 /* Exception Handlers */
-extern void supGeneralExceptionHandler();
+extern void supGeneralExceptionHandler(support_t *supportPtr);
 extern void supSyscallHandler(support_t *supportPtr);
 extern void supProgramTrapHandler();
 
@@ -77,6 +77,7 @@ typedef struct swap_t {
 	unsigned int swap_asid;		/* process id */
 	unsigned int swap_pageNo;	/* page number */
 	ptEntry_t *swap_ptePtr;		/* pointer to page table entry */
+	int swap_ref;				/* TRUE if used since the clock hand passed */
 } swap_t, *swap_PTR;
 
 /* process context */
@@ -95,6 +96,10 @@ typedef struct support_t {
 	int 		sup_stackTLB[500];		/* stack for TLB refill */
 	int 		sup_stackGen[500];	/* stack for general exceptions */
 	int 		sup_privateSem;
+	int			sup_hardFaults;			/* page faults that read flash */
+	int			sup_softFaults;			/* page faults served without I/O */
+	int			sup_pageOuts;			/* pages written back for its faults */
+	int			sup_dirtyFaults;		/* first writes to clean pages */
 	/*... other fields to be added later*/
 } support_t;
 
@@ -107,6 +112,8 @@ typedef struct pcb_t {
 	/* process queue fields */
     struct pcb_t   *p_next;							/* ptr to next entry			*/
     struct pcb_t   *p_prev; 						/* ptr to previous entry		*/
+    struct pcb_t   **p_procQ;						/* ptr to tail ptr of the queue	*/
+													/* holding proc, NULL if none	*/
 
 	/* process tree fields */
 	struct pcb_t	*p_prnt, 						/* ptr to parent				*/
@@ -117,19 +124,76 @@ typedef struct pcb_t {
 	/* process status information */
 	state_t			p_s;							/* processor state				*/
 	cpu_t			p_time;							/* cpu time used by proc		*/
+	int				p_prio;							/* ready queue level, 0 highest	*/
+	cpu_t			p_quantum;						/* slice at level 0, in usecs	*/
+	cpu_t			p_sliceLeft;					/* slice left if preempted, or 0	*/
+	int				p_yields;						/* times blocked before the PLT	*/
+	int				p_preempts;						/* times preempted by the PLT	*/
+	int				p_wokeWaiter;					/* TRUE if it V'd a waiter		*/
+	int				p_blocksAfterV;					/* TRUE if it blocked after V	*/
+	int				p_tickets;						/* stride tickets, 0 for MLFQ	*/
+	unsigned int	p_stride;						/* STRIDE1 / p_tickets			*/
+	unsigned int	p_pass;							/* stride pass value			*/
+	cpu_t			p_period;						/* real-time period, 0 for none	*/
+	cpu_t			p_budget;						/* CPU time of one job			*/
+	int				p_util;							/* budget / period, UTILSCALE	*/
+	cpu_t			p_release;						/* TOD of the next job release	*/
+	cpu_t			p_deadline;						/* TOD deadline of current job	*/
+	cpu_t			p_remaining;					/* budget left in current job	*/
+	int				p_throttled;					/* TRUE if out of budget		*/
+	int				p_jobMissed;					/* TRUE if current job missed	*/
+	int				p_jobs;							/* real-time jobs released		*/
+	int				p_misses;						/* real-time deadlines missed	*/
+	cpu_t			p_charged;						/* p_time already charged		*/
+	unsigned int	p_heapKey;						/* pass or deadline in a heap	*/
+	int				p_heapIdx;						/* slot in its heap, or -1		*/
+	int				p_inheritPrio;					/* level inherited from waiters	*/
+	struct semd_t	*p_owned;						/* semaphores held as mutexes	*/
 	int				*p_semAdd;						/* ptr to semaphore on			*/
 													/* which proc is blocked		*/
+	unsigned int	p_clockGen;						/* pseudo-clock tick waited for	*/
 	/* support layer information */
 	support_t		*p_supportStruct;			
 }  pcb_t, *pcb_PTR;
 
+/* PCB slab descriptor type */
+typedef struct pcbSlab_t {
+	struct pcbSlab_t *sl_next;						/* next slab with free pcbs		*/
+	pcb_t			*sl_base;						/* first pcb of the slab		*/
+	pcb_t			*sl_free;						/* tail ptr of free pcb queue	*/
+	int				sl_size;						/* number of pcbs in the slab	*/
+} pcbSlab_t, *pcbSlab_PTR;
+
+/* binary min-heap of pcbs on p_heapKey, for the stride and real-time classes */
+typedef struct procHeap_t {
+	pcb_PTR			h_proc[MAXPCBS];				/* the heap, earliest key first	*/
+	int				h_count;						/* pcbs in the heap				*/
+} procHeap_t;
+
 /* Semaphore descriptor type*/
 typedef struct semd_t {
 	struct semd_t 	*s_next;
 	int 			*s_semAdd;
 	pcb_t 			*s_procQ;
+	pcb_t			*s_owner;		/* process holding the semaphore	*/
+	struct semd_t	*s_nextOwned;	/* next semaphore held by s_owner	*/
 } semd_t, *semd_PTR;
 
+/* a device completion, acknowledged but not yet handled */
+typedef struct devWork_t {
+	int				w_devIndex;		/* device index of the (sub)device	*/
+	int				w_status;		/* its status at the acknowledgement */
+} devWork_t;
+
+/* kernel info page, kept up to date by the nucleus and mapped read-only
+   into every U-proc at KINFOPAGE */
+typedef struct kinfo_t {
+	unsigned int	ki_seq;			/* changes with every update		*/
+	cpu_t			ki_tod;			/* TOD at the last update			*/
+	cpu_t			ki_cpuTime;		/* CPU time of the running process	*/
+	unsigned int	ki_ticks;		/* pseudo-clock intervals since boot */
+} kinfo_t;
+
 typedef struct delayd_t {
 	struct delayd_t *d_next;
 	cpu_t 			d_wakeTime;
@@ -18,7 +18,7 @@
 extern void toggleInterrupts(int enable);
 extern void mutex(int on, int *semAddress);
 extern void initSwapStructs();
-extern void supTlbExceptionHandler();
+extern void supTlbExceptionHandler(support_t *supportPtr);
 extern void markAllFramesFree(int asid);
 
 #endif 
@@ -5,16 +5,26 @@
 *
 *  The implementation file for the Active Semaphore List. 
 *  
-*  The ASL is a list of semd_t nodes, each of which contains a
+*  The ASL is a hash table of semd_t nodes, each of which contains a
 *  semaphore address (semAdd) and a pointer to a queue of processes. 
-*  The list is ordered by semAdd in ascending order.
+*  Nodes are hashed on semAdd into ASLHASHSIZE buckets; each bucket is an
+*  unordered singly-linked chain. ASLHASHSIZE is the power of two at or
+*  above MAXSEMD / 2, so even a full table averages at most two nodes per
+*  bucket and lookups take expected constant time.
+*  A node is also kept while some process holds its semaphore as a mutex
+*  (s_owner), which is what priority inheritance works from.
 *  - insertBlocked: inserts a process in the queue of the semaphore
 *  - removeBlocked: removes a process from the queue of the semaphore
 *  - outBlocked: removes a process from the queue of the semaphore
 *  - headBlocked: returns the first process in the queue of the semaphore
 *  - initASL: initializes the ASL
-*  Helper function: traverseASL, which traverses the ASL to find the
-*  correct position to insert a semaphore.
+*  - semOwner/setSemOwner/clearSemOwner: track the holder of a semaphore
+*  - releaseOwned: drops every semaphore held by a process
+*  - ownedCeiling: highest priority waiting on a process's semaphores
+*  Helper functions: hashASL, which maps a semAdd to its bucket, 
+*  lookupASL, which finds the node of a semAdd in its bucket, allocSemd,
+*  which puts a new node in its bucket, and freeSemd, which unlinks an
+*  unused node and returns it to the free list.
 *
 *  Written by Khoa Ho & Hieu Tran
 *  February 2025
@@ -22,49 +32,115 @@
 
 
 /* Global variables */
-HIDDEN semd_t *semd_h;              /* Head of the active semaphore list */ 
-HIDDEN semd_t *semdFree_h;          /* Head of the free semaphore list */
-HIDDEN semd_t semdTable[MAXPROC+2]; /* Array of semaphores */
+HIDDEN semd_t *semdHash[ASLHASHSIZE]; /* Buckets of the active semaphore list */ 
+HIDDEN semd_t *semdFree_h;            /* Head of the free semaphore list */
+HIDDEN int semdFreeCount;             /* Number of free semaphores */
+HIDDEN semd_t semdTable[MAXSEMD];     /* Array of semaphores */
 
 /****************************************************************************
-* Helper function: traverseASL
-* Traverse the ASL to find the correct position to insert a semaphore.
-* Returns the semaphore node with the given semAdd.
+* Helper function: hashASL
+* Returns the bucket of the ASL for the given semAdd. Semaphores are word
+* aligned, so the low two bits of the address are dropped.
+*/
+HIDDEN semd_t **hashASL(int *semAdd) {
+    return &(semdHash[((memaddr) semAdd >> 2) & (ASLHASHSIZE - 1)]);
+}
+
+/****************************************************************************
+* Helper function: lookupASL
+* Searches the bucket of semAdd for its semaphore node.
+* Returns the semaphore node with the given semAdd, and sets prev to the
+* node before it in the bucket (NULL if it is first).
 * If the semaphore node does not exist, returns NULL.
 */
-HIDDEN semd_t *traverseASL(int *semAdd, semd_t **prev) {
-    *prev = semd_h;  
-    semd_t *curr = semd_h->s_next; /* Skip the first dummy node */
-    while (curr->s_semAdd < semAdd) {
+HIDDEN semd_t *lookupASL(int *semAdd, semd_t **prev) {
+    *prev = NULL;
+    semd_t *curr = *hashASL(semAdd);
+    while (curr != NULL && curr->s_semAdd != semAdd) {
         *prev = curr;
         curr = curr->s_next;
     }
     return curr;
 }
 
+/****************************************************************************
+* Helper function: allocSemd
+* Takes a node off the free list and puts it at the front of the bucket of
+* semAdd, with an empty process queue and no owner.
+* Returns the new node, or NULL if there are no free nodes.
+*/
+HIDDEN semd_t *allocSemd(int *semAdd) {
+    if (semdFree_h == NULL) {
+        /* No more free semaphores */
+        return NULL;
+    }
+    semd_t *sem = semdFree_h;
+    semdFree_h = sem->s_next;
+    semdFreeCount--;
+
+    sem->s_semAdd = semAdd;
+    sem->s_procQ = mkEmptyProcQ();
+    sem->s_owner = NULL;
+    sem->s_nextOwned = NULL;
+    sem->s_next = *hashASL(semAdd);
+    *hashASL(semAdd) = sem;
+    return sem;
+}
+
+/****************************************************************************
+* Helper function: freeSemd
+* Unlinks the semaphore node sem, whose predecessor in its bucket is prev,
+* and returns it to the free list, unless processes are still blocked on
+* it or some process still holds it.
+*/
+HIDDEN void freeSemd(semd_t *sem, semd_t *prev) {
+    if (!emptyProcQ(sem->s_procQ) || sem->s_owner != NULL) {
+        return;
+    }
+    if (prev == NULL) {
+        *hashASL(sem->s_semAdd) = sem->s_next;
+    } else {
+        prev->s_next = sem->s_next;
+    }
+    sem->s_next = semdFree_h;
+    semdFree_h = sem;
+    semdFreeCount++;
+}
+
+/****************************************************************************
+* Helper function: unlinkOwned
+* Removes sem from the list of semaphores held by its owner.
+*/
+HIDDEN void unlinkOwned(semd_t *sem) {
+    pcb_PTR owner = sem->s_owner;
+    if (owner->p_owned == sem) {
+        owner->p_owned = sem->s_nextOwned;
+    } else {
+        semd_t *curr = owner->p_owned;
+        while (curr->s_nextOwned != sem) {
+            curr = curr->s_nextOwned;
+        }
+        curr->s_nextOwned = sem->s_nextOwned;
+    }
+    sem->s_owner = NULL;
+    sem->s_nextOwned = NULL;
+}
+
 /****************************************************************************
  * Function: insertBlocked
  * Inserts a process in the queue of the semaphore with the given semAdd.
  * If the semaphore does not exist, creates a new semaphore node.
- * Returns TRUE if the semaphore is not found.
+ * Returns TRUE if a new semaphore node is needed and none is free.
  */
 int insertBlocked(int *semAdd, pcb_PTR p) {
     semd_t *prev; /* Pointer to the previous semaphore node */
-    semd_t *sem = traverseASL(semAdd, &prev);
-    if (sem->s_semAdd != semAdd) {
-        /* Semaphore does not exist */
-        if (semdFree_h == NULL)
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL) {
+        /* Semaphore does not exist, get a free one */
+        sem = allocSemd(semAdd);
+        if (sem == NULL)
             /* No more free semaphores */
             return TRUE;
-        
-        /* Get a free semaphore */
-        sem = semdFree_h;
-        semdFree_h = sem->s_next;
-        sem->s_semAdd = semAdd;
-        sem->s_procQ = mkEmptyProcQ();
-        /* Insert new semaphore in correct position */ 
-        sem->s_next = prev->s_next;
-        prev->s_next = sem;
     }
     insertProcQ(&(sem->s_procQ), p);
     p->p_semAdd = sem->s_semAdd;
@@ -74,55 +150,44 @@ int insertBlocked(int *semAdd, pcb_PTR p) {
 /****************************************************************************
  * Function: removeBlocked
  * Removes the head pcb from the queue of the semaphore with the given semAdd.
- * If the semaphore does not exist, returns NULL.
+ * If the semaphore does not exist or has no waiters, returns NULL.
  */
 pcb_PTR removeBlocked(int *semAdd) {
     semd_t *prev;
-    semd_t *sem = traverseASL(semAdd, &prev);
-    if (sem->s_semAdd != semAdd) {
-        /* Semaphore does not exist */
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL || emptyProcQ(sem->s_procQ)) {
+        /* Semaphore does not exist or the queue is empty */
         return NULL;
     }
     pcb_PTR p = removeProcQ(&(sem->s_procQ));
     p->p_semAdd = NULL;
 
-    if (emptyProcQ(sem->s_procQ)) {
-        /* If the semaphore queue becomes empty, remove the semaphore */
-        prev->s_next = sem->s_next;
-        sem->s_next = semdFree_h;
-        semdFree_h = sem;
-    }
+    /* If the semaphore queue becomes empty, remove the semaphore */
+    freeSemd(sem, prev);
     return p;
 }
 
 /****************************************************************************
  * Function: outBlocked
  * Removes the pcb pointed to by p from the process queue associated with 
- * p's semaphore.
- * If the semaphore does not exist, returns NULL.
+ * p's semaphore. The node is found through p->p_semAdd, so only p's own 
+ * bucket is searched and the unlink itself takes constant time.
+ * If the semaphore does not exist or p is not on its queue, returns NULL.
  */
 pcb_PTR outBlocked(pcb_PTR p) {
-    semd_t *prev = semd_h;
-    semd_t *sem = semd_h->s_next;
-    while (sem != NULL) {
-        /* Traverse the ASL */
-        pcb_PTR removed = outProcQ(&(sem->s_procQ), p);
-        if (removed != NULL) {
-            /* If the process is found */
-            if (emptyProcQ(sem->s_procQ)) {
-                /* If the semaphore queue becomes empty, remove the semaphore */
-                prev->s_next = sem->s_next;
-                sem->s_next = semdFree_h;
-                semdFree_h = sem;
-            }
-            removed->p_semAdd = NULL;
-            return removed;
-        }
-        /* Move to the next semaphore */
-        prev = sem;
-        sem = sem->s_next;
+    if (p->p_semAdd == NULL) {
+        /* p is not blocked on any semaphore */
+        return NULL;
     }
-    return NULL;
+    semd_t *prev;
+    semd_t *sem = lookupASL(p->p_semAdd, &prev);
+    if (sem == NULL || outProcQ(&(sem->s_procQ), p) == NULL) {
+        return NULL;
+    }
+    /* If the semaphore queue becomes empty, remove the semaphore */
+    freeSemd(sem, prev);
+    p->p_semAdd = NULL;
+    return p;
 }
 
 /****************************************************************************
@@ -131,9 +196,9 @@ pcb_PTR outBlocked(pcb_PTR p) {
  * If the semaphore does not exist or the queue is empty, returns NULL.
  */
 pcb_PTR headBlocked(int *semAdd) {
-    semd_t *prev = semd_h;
-    semd_t *sem = traverseASL(semAdd, &prev);
-    if (sem->s_semAdd != semAdd || emptyProcQ(sem->s_procQ)) {
+    semd_t *prev;
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL || emptyProcQ(sem->s_procQ)) {
         /* Semaphore does not exist or the queue is empty */
         return NULL;
     }
@@ -143,29 +208,109 @@ pcb_PTR headBlocked(int *semAdd) {
 /****************************************************************************
  * Function: initASL
  * Initializes the ASL.
- * The ASL contains a dummy node at the beginning and the end of the list.
- * The ASL also contains a list of free semd_t nodes.
+ * All buckets of the ASL start out empty and every semd_t node is put on 
+ * the list of free nodes.
  */
 void initASL() {
     /* Initialize the active semaphore list */
-    semd_h = &(semdTable[0]);
-    semd_h->s_semAdd = (int*)(0x00000000); /* 0 for first dummy node */
-    semd_h->s_procQ = NULL;
-
-    semd_h->s_next = &(semdTable[MAXPROC+1]);
-    semd_h->s_next->s_procQ = NULL;
-    semd_h->s_next->s_next = NULL;
-    semd_h->s_next->s_semAdd = (int*)MAXINT; /* MAXINT for last dummy node */
+    int i;
+    for (i = 0; i < ASLHASHSIZE; i++) {
+        semdHash[i] = NULL;
+    }
 
     /* Initialize the free semaphore list */
-    semdFree_h = &semdTable[1];
-    semd_t *temp = semdFree_h;
-    int i;
-    for (i = 2; i < MAXPROC+1; i++) {
-        temp->s_next = &(semdTable[i]);
-        temp->s_procQ = NULL;
-        temp = temp->s_next;
-    }
-    temp->s_procQ = NULL;
-    temp->s_next = NULL;
-}
\ No newline at end of file
+    semdFree_h = NULL;
+    for (i = 0; i < MAXSEMD; i++) {
+        semdTable[i].s_procQ = NULL;
+        semdTable[i].s_next = semdFree_h;
+        semdFree_h = &(semdTable[i]);
+    }
+    semdFreeCount = MAXSEMD;
+}
+
+/****************************************************************************
+ * Function: semOwner
+ * Returns the process holding the semaphore with the given semAdd, or NULL
+ * if no process is recorded as holding it.
+ */
+pcb_PTR semOwner(int *semAdd) {
+    semd_t *prev;
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL) {
+        return NULL;
+    }
+    return sem->s_owner;
+}
+
+/****************************************************************************
+ * Function: setSemOwner
+ * Records p as the holder of the semaphore with the given semAdd, taking
+ * it away from its previous holder if there was one. A new node is only 
+ * created while more than MAXPCBS nodes are free, so that ownership can 
+ * never use up the nodes needed to block processes.
+ * Returns TRUE if the ownership could not be recorded.
+ */
+int setSemOwner(int *semAdd, pcb_PTR p) {
+    semd_t *prev;
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL) {
+        if (semdFreeCount <= MAXPCBS) {
+            return TRUE;
+        }
+        sem = allocSemd(semAdd);
+    } else if (sem->s_owner != NULL) {
+        unlinkOwned(sem);
+    }
+    sem->s_owner = p;
+    sem->s_nextOwned = p->p_owned;
+    p->p_owned = sem;
+    return FALSE;
+}
+
+/****************************************************************************
+ * Function: clearSemOwner
+ * Records that no process holds the semaphore with the given semAdd.
+ * The node is freed if no process is blocked on it.
+ */
+void clearSemOwner(int *semAdd) {
+    semd_t *prev;
+    semd_t *sem = lookupASL(semAdd, &prev);
+    if (sem == NULL || sem->s_owner == NULL) {
+        return;
+    }
+    unlinkOwned(sem);
+    freeSemd(sem, prev);
+}
+
+/****************************************************************************
+ * Function: releaseOwned
+ * Records that p holds none of the semaphores it holds. Called when p is
+ * terminated, so that no node refers to a freed pcb.
+ */
+void releaseOwned(pcb_PTR p) {
+    while (p->p_owned != NULL) {
+        clearSemOwner(p->p_owned->s_semAdd);
+    }
+}
+
+/****************************************************************************
+ * Function: ownedCeiling
+ * Returns the highest priority (lowest level) among the processes blocked
+ * on the semaphores held by p, counting the priority each of them has 
+ * inherited in turn. Returns MLFQLEVELS if no process waits on them.
+ */
+int ownedCeiling(pcb_PTR p) {
+    int ceiling = MLFQLEVELS;
+    semd_t *sem = p->p_owned;
+    while (sem != NULL) {
+        pcb_PTR waiter = sem->s_procQ;
+        if (!emptyProcQ(waiter)) {
+            do {
+                ceiling = MIN(ceiling, MIN(waiter->p_prio, waiter->p_inheritPrio));
+                waiter = waiter->p_next;
+            } while (waiter != sem->s_procQ);
+        }
+        sem = sem->s_nextOwned;
+    }
+    return ceiling;
+}
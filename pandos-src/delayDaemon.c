@@ -7,6 +7,8 @@
  * The ADL is a linked list of delay nodes that keeps track of U-processes
  * that are blocked for a specified delay duration. The Delay Daemon processes 
  * the ADL and wakes up U-processes when their delay time has expired.
+ * While the ADL is empty the Delay Daemon sleeps on adl_wakeup instead of
+ * waiting for pseudo-clock ticks, so an idle system takes no ticks.
  *
  * Written by: Hieu Tran and Khoa Ho
  * May 2025
@@ -17,6 +19,7 @@ HIDDEN delayd_t delayd_table[UPROCMAX + 2]; /* ADL table with dummy head and tai
 HIDDEN delayd_t *delaydFree_h;              /* free list of delayd_t nodes */
 HIDDEN delayd_t *delayd_h;                  /* head of the ADL */
 HIDDEN int adl_sem = 1;                     /* semaphore for ADL mutual exclusion */
+HIDDEN int adl_wakeup = 0;                  /* V'd when the ADL stops being empty */
 
 /* Helper functions */
 /****************************************************************************
@@ -179,9 +182,21 @@ void initADL() {
  * exclusion over the ADL using a semaphore. It processes expired delay
  * events by performing a V on the associated U-proc's private
  * semaphore and returns the event descriptors to the free list.
+ * When the ADL is empty it does not wait for ticks, but sleeps until 
+ * delayFacility adds the first event.
  */
 void delayDaemon() {
     while (TRUE) {
+        mutex(ON, &adl_sem);
+        int empty = (delayd_h->d_next->d_supStruct == NULL);  /* only the tail */
+        mutex(OFF, &adl_sem);
+
+        if (empty) {
+            /* sleep until there is a delay to time */
+            SYSCALL(PASSEREN, (int) &adl_wakeup, 0, 0);
+            continue;
+        }
+
         /* wait for pseudoclock signal */
         SYSCALL(WAITFORCLOCK, 0, 0, 0); 
 
@@ -203,7 +218,7 @@ void delayDaemon() {
  * 2. Allocates a delay event descriptor from the free list.
  *    If allocation fails, the U-proc is terminated.
  * 3. Calculates the wake-up time and inserts the descriptor into the
- *    ADL in order.
+ *    ADL in order. If the ADL was empty, wakes the Delay Daemon.
  * 4. Atomically releases mutual exclusion over the ADL and performs a 
  *    P on the U-proc’s private semaphore, blocking the U-proc.
  *    This ensures the process sleeps until the Delay Daemon wakes it.
@@ -230,13 +245,18 @@ void delayFacility(support_t *supportPtr) {
     /* set up the delay event descriptor */
     node->d_supStruct = supportPtr;
     node->d_wakeTime = now + ((cpu_t)delayDuration * MICROSECONDS);
+    int wasEmpty = (delayd_h->d_next->d_supStruct == NULL);
     delayd_insertADL(node);
+    if (wasEmpty) {
+        /* the Delay Daemon sleeps while the ADL is empty */
+        mutex(OFF, &adl_wakeup);
+    }
 
     toggleInterrupts(OFF);
     /* release mutex over ADL & allow Delay Daemon to process it */
     mutex(OFF, &adl_sem);
     /* perform P on the U-proc's private semaphore & block it from running */
-    mutex(ON, &(supportPtr->sup_privateSem));
+    SYSCALL(PASSEREN, (int) &(supportPtr->sup_privateSem), 0, 0);
     toggleInterrupts(ON);
 }
 
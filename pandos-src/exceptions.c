@@ -29,21 +29,44 @@
 *      system instability.
 *  - System calls issued from user-mode processes that request privileged
 *    operations result in a program trap.
+*  - A few support level syscalls that only read state (SYS10, SYS22, 
+*    SYS23) are answered by the nucleus straight away, without passing
+*    them up, with the same result the support level would give.
 *
 *  System Calls:
 *  - SYS1: createProcess - Creates a new process with specified state
-*  - SYS2: terminateProcess - Recursively terminates a process and its progeny
+*  - SYS2: terminateProcess - Terminates a process and its progeny
 *  - SYS3: passeren - P operation on semaphores: decrements and blocks if negative
 *  - SYS4: verhogen - V operation on semaphores: increments and unblocks waiters
 *  - SYS5: waitIO - Blocks process pending I/O completion on specified device
 *  - SYS6: getCPUTime - Returns accumulated CPU time used by current process
 *  - SYS7: waitClock - Blocks process until the next clock tick
 *  - SYS8: getSupportData - Retrieves pointer to support structure
+*  - SYS21: setPriority - Sets the priority level of the current process
+*  - SYS22: getPriority - Returns the priority level of the current process
+*  - SYS23: getSchedInfo - Returns the quantum or switch counts of the 
+*    current process
+*  - SYS24: setTickets - Moves the current process to or from the stride
+*    scheduling class
+*  - SYS25: setRealTime - Moves the current process to or from the 
+*    earliest-deadline-first real-time class
+*  - SYS26: setHandoff - Turns handoff on V on or off for a semaphore, or
+*    for processes that block right after a V
+*
+*  Semaphores taken as mutexes through SYS3 (a2 TRUE) implement priority
+*  inheritance: the process holding one runs at the priority of its 
+*  highest waiter. Semaphores only used to signal have no holder.
+*  A V with handoff runs the woken process at once, for the rest of the 
+*  caller's slice, and queues the caller at the head of its ready queue, 
+*  so that request/response pairs do not wait a round-robin turn per hop.
 *
 *  Written by: Khoa Ho & Hieu Tran
 *  March 2025
 ****************************************************************************/
 
+HIDDEN int *handoffSems[HANDOFFMAX];  /* semaphores whose V hands off */
+HIDDEN int handoffCount = 0;          /* entries in handoffSems */
+HIDDEN int handoffAuto = FALSE;       /* hand off for processes blocking after V */
 
 /***************************************************************************
  * Helper function: storeState
@@ -58,6 +81,21 @@ HIDDEN void storeState(state_PTR oldState) {
     copyState(oldState, &(currentProcess->p_s));  /* Copy state to current process */
 }
 
+/***************************************************************************
+ * Helper function: resumeCaller
+ * Returns control to the process that issued the syscall, which is still
+ * the current process. It resumes straight from the exception state in
+ * the BIOS data page, so the state is not copied into the PCB at all; 
+ * only a syscall that gives up the processor needs storeState.
+ * 
+ * Parameters:
+ * oldState: Pointer to the saved exception state
+ */
+HIDDEN void resumeCaller(state_PTR oldState) {
+    oldState->s_pc += WORDLEN;  /* Increment PC to next instruction */
+    loadNextState(oldState);
+}
+
 /***************************************************************************
  * Function: exceptionHandler
  * Main exception handler - Entry point for all exceptions.
@@ -82,6 +120,38 @@ void exceptionHandler() {
     }
 }
 
+/***************************************************************************
+ * Helper function: fastSupportSyscall
+ * Answers a syscall issued by a U-proc in user mode, if it is one of the
+ * support level syscalls with no side effects, and resumes the U-proc. 
+ * Passing these up would cost a switch to the support level, its dispatch
+ * and a LDST back, only to read a value.
+ * Returns only if the syscall must be passed up.
+ * 
+ * Parameters:
+ * excState: Pointer to the saved exception state
+ * syscallCode: The syscall code in a0
+ */
+HIDDEN void fastSupportSyscall(state_PTR excState, int syscallCode) {
+    switch (syscallCode) {
+        case GETTOD: {
+            cpu_t tod;
+            STCK(tod);  /* SYS10 */
+            excState->s_v0 = tod;
+            resumeCaller(excState);
+            break;
+        }
+        case GETPRIORITY: {
+            getPriority();  /* SYS22 */
+            break;
+        }
+        case GETSCHEDINFO: {
+            getSchedInfo();  /* SYS23 */
+            break;
+        }
+    }
+}
+
 /***************************************************************************
  * Function: interruptHandler
  * System call handler - Processes SYSCALL exceptions.
@@ -94,11 +164,14 @@ void syscallHandler() {
     
     /* Check if in user mode and attempting privileged syscalls */
     if ((excState->s_status & KUPON) != ALLOFF) {
+        if (currentProcess->p_supportStruct != NULL) {
+            fastSupportSyscall(excState, syscallCode);
+        }
         excState->s_cause = (excState->s_cause & RICODE); /* set cause.ExcCode bits to RI */
         programTrapHandler(); 
     }
 
-    if (syscallCode > GETSUPPORT) {
+    if (syscallCode > GETSUPPORT && syscallCode < SETPRIORITY) {
         programTrapHandler();
     }
     
@@ -136,6 +209,30 @@ void syscallHandler() {
             getSupportData();  /* SYS8 */
             break;
         }
+        case SETPRIORITY: {
+            setPriority();  /* SYS21 */
+            break;
+        }
+        case GETPRIORITY: {
+            getPriority();  /* SYS22 */
+            break;
+        }
+        case GETSCHEDINFO: {
+            getSchedInfo();  /* SYS23 */
+            break;
+        }
+        case SETTICKETS: {
+            setTickets();  /* SYS24 */
+            break;
+        }
+        case SETREALTIME: {
+            setRealTime();  /* SYS25 */
+            break;
+        }
+        case SETHANDOFF: {
+            setHandoff();  /* SYS26 */
+            break;
+        }
         default: {			
             passUpOrDie(GENERALEXCEPT);  /* Unknown syscall - pass up or terminate */
             break;
@@ -168,106 +265,284 @@ void createProcess() {
 
         /* Initialize process and add to ready queue */
         processCount++;
-        insertProcQ(&readyQueue, newProc);
+        readyProcess(newProc);
         insertChild(currentProcess, newProc);  /* Make child of current process */
         oldState->s_v0 = 0;  /* Success return value */
     }
-    storeState(oldState);  
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    resumeCaller(oldState);  /* Return control to caller */
 }
 
 /***************************************************************************
- * Function: terminateProcess (SYS2)
- * Recursively terminates a process and all its children.
- * Handles cleanup of semaphore blocks, process counts,
- * and PCB resources.
+ * Helper function: updateInheritance
+ * Recomputes the priority p inherits from the processes waiting on the
+ * semaphores it holds. If it changed and p is itself blocked on a held
+ * semaphore, the change is passed on to that semaphore's holder, and so on
+ * along the chain (bounded by MAXPCBS in case of a deadlock cycle).
  * 
  * Parameters:
- * current: Pointer to the PCB to terminate
+ * p: Pointer to the PCB to update, or NULL
  */
-void terminateProcess(pcb_PTR current) {
-    /* Recursively terminate all children first */
-    while (emptyChild(current) == FALSE) {
-        terminateProcess(removeChild(current));
+HIDDEN void updateInheritance(pcb_PTR p) {
+    int hops = 0;
+    while (p != NULL && hops < MAXPCBS) {
+        int prio = ownedCeiling(p);
+        if (prio == p->p_inheritPrio) {
+            return;  /* Nothing changes further along the chain */
+        }
+        inheritPrio(p, prio);
+        if (p->p_semAdd == NULL) {
+            return;  /* p is not blocked */
+        }
+        p = semOwner(p->p_semAdd);
+        hops++;
     }
+}
 
-    /* Handle blocked processes and semaphore adjustment */
-    if ((current->p_semAdd) != NULL) {
-        if ((current->p_semAdd >= &deviceSemaphores[0]) && (current->p_semAdd <= &deviceSemaphores[CLOCK])) {
+/***************************************************************************
+ * Helper function: releaseProcess
+ * Takes a single process with no children out of whatever queue it is on,
+ * adjusts the semaphore and process counts, and frees its PCB.
+ * 
+ * Parameters:
+ * p: Pointer to the PCB to release
+ */
+HIDDEN void releaseProcess(pcb_PTR p) {
+    settleTickWaiter(p);  /* A tick may have readied it already */
+    if (p == currentProcess) {
+        /* The running process is on no queue */
+        processCount--;
+    } else if ((p->p_semAdd) != NULL) {
+        pcb_PTR removed;
+        if (p->p_semAdd == &deviceSemaphores[CLOCK]) {
+            /* Waiting for a tick, on a clock queue or the CLOCK queue */
+            softBlockCount--;
+            removed = outTickWaiter(p);
+        } else if ((p->p_semAdd >= &deviceSemaphores[0]) && (p->p_semAdd < &deviceSemaphores[CLOCK])) {
             /* If the process is blocked on a device semaphore, remove it
-            from the blocked queue and decrement the soft block count */
+            from the device's wait queue and decrement the soft block count */
             softBlockCount--;  
+            removed = outProcQ(&(deviceQueues[p->p_semAdd - deviceSemaphores]), p);
         } else {
-            int *semAddress = current->p_semAdd;
+            int *semAddress = p->p_semAdd;
             (*semAddress) += 1; 
+            removed = outBlocked(p);  /* Remove from blocked queue */
+            updateInheritance(semOwner(semAddress));  /* One waiter fewer */
         }
-        pcb_PTR p = outBlocked(current);  /* Remove from blocked queue */
-        if(p != mkEmptyProcQ()) {
+        if (removed != NULL) {
             processCount--;  
         }
-    } else {
+    } else if (outReady(p) != NULL) {
         /* If not blocked, remove from ready queue */
-        pcb_PTR p = outProcQ(&readyQueue, current);
-        if (p != mkEmptyProcQ()) {
-            processCount--;  
-        }
+        processCount--;  
     }
+    leaveRealTime(p);  /* Give back its real-time utilization */
+    releaseOwned(p);  /* p no longer holds any semaphore */
+    freePcb(p);  /* Return PCB to free list */
+}
 
-    /* Special handling if terminating the current process */
-    if (current == currentProcess) {
-        if (!emptyChild(current))  {
-            outChild(currentProcess);  
+/***************************************************************************
+ * Function: terminateProcess (SYS2)
+ * Terminates a process and all its progeny.
+ * The subtree is torn down in post-order without recursion: descend to a
+ * leaf, release it, and continue from its parent. This uses a constant
+ * amount of nucleus stack however deep the tree is. If the current process
+ * was part of the subtree, the scheduler is called once at the end.
+ * 
+ * Parameters:
+ * root: Pointer to the PCB at the root of the subtree to terminate
+ */
+void terminateProcess(pcb_PTR root) {
+    int killedCurrent = FALSE;
+    pcb_PTR p = root;
+    pcb_PTR parent;
+
+    outChild(root);  /* Detach the subtree, so the root has no parent */
+
+    while (p != NULL) {
+        /* Descend to a leaf of what is left of the subtree */
+        while (!emptyChild(p)) {
+            p = p->p_child;
         }
+        parent = p->p_prnt;  /* NULL once the root is reached */
+        outChild(p);
+
+        if (p == currentProcess) {
+            killedCurrent = TRUE;
+        }
+        releaseProcess(p);
+        p = parent;
+    }
+
+    if (killedCurrent) {
+        /* Hand off to the scheduler only after the whole subtree is gone */
         currentProcess = mkEmptyProcQ();  
-        processCount--;  
         scheduler();  
     }
-    freePcb(current);  /* Return PCB to free list */
 }
 
 /***************************************************************************
  * Function: passeren (SYS3)
  * Performs P operation on semaphore specified in a1.
- * If semaphore becomes negative, blocks the current process.
+ * If semaphore becomes negative, blocks the current process and lends its
+ * priority to the process holding the semaphore. With a2 TRUE the 
+ * semaphore is taken as a mutex: if the P takes the last unit, the current
+ * process becomes its holder. A P with a2 FALSE, on a semaphore used to
+ * signal, records no holder.
  */
 void passeren() { 
     state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
     cpu_t TOD_current;
     STCK(TOD_current);  /* Get current time */
     int *semAddress = (int *) oldState->s_a1;   /* Get semaphore address from a1 */
+    int asMutex = (oldState->s_a2 != FALSE);    /* Taken as a mutex (a2) */
 
     (*semAddress)--;  
 
-    storeState(oldState);  
     if (*semAddress < 0) {
         /* If semaphore negative, block process */
+        storeState(oldState);  
         insertBlocked(semAddress, currentProcess);  /* Add to blocked queue */
         currentProcess->p_time += (TOD_current - TOD_start);  /* Update CPU time */
+        currentProcess->p_blocksAfterV = currentProcess->p_wokeWaiter;
+        currentProcess->p_wokeWaiter = FALSE;
+        if (quantumBlocked(currentProcess)) {
+            promoteProcess(currentProcess);  /* Dispatch it again soon */
+        }
+        pcb_PTR holder = semOwner(semAddress);
+        if (holder != currentProcess) {
+            updateInheritance(holder);  /* Boost the holder, never the waiter itself */
+        }
         currentProcess = NULL;  /* Clear current process */
         scheduler(); 
     }
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    if (asMutex && *semAddress == 0) {
+        /* The semaphore is taken as a mutex */
+        pcb_PTR oldOwner = semOwner(semAddress);
+        setSemOwner(semAddress, currentProcess);
+        if (oldOwner != currentProcess) {
+            updateInheritance(oldOwner);
+        }
+    }
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Helper function: handoffIndex
+ * Returns the entry of the semaphore at semAddress in handoffSems, or -1
+ * if a V on it does not hand off.
+ */
+HIDDEN int handoffIndex(int *semAddress) {
+    int i;
+    for (i = 0; i < handoffCount; i++) {
+        if (handoffSems[i] == semAddress) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/***************************************************************************
+ * Helper function: wantsHandoff
+ * Returns TRUE if the current process, which has just woken p with a V on
+ * the semaphore at semAddress, should hand the processor over to p: the 
+ * semaphore hands off, or the current process usually blocks right after
+ * such a V and handoff is on for those. Only MLFQ processes hand off, so
+ * that stride shares and real-time budgets are kept.
+ */
+HIDDEN int wantsHandoff(int *semAddress, pcb_PTR p) {
+    if (p->p_period > 0 || p->p_tickets > 0 ||
+        currentProcess->p_period > 0 || currentProcess->p_tickets > 0) {
+        return FALSE;
+    }
+    return (handoffIndex(semAddress) >= 0) || 
+           (handoffAuto && currentProcess->p_blocksAfterV);
+}
+
+/***************************************************************************
+ * Helper function: handOff
+ * Switches from the current process, which issued the syscall, to p. The
+ * caller is queued at the head of its ready queue, and p runs for what is
+ * left of the caller's slice: the PLT is not reloaded, but p's use of the
+ * slice is counted from here.
+ * 
+ * Parameters:
+ * oldState: Pointer to the saved exception state of the caller
+ * p: The process to run
+ */
+HIDDEN void handOff(state_PTR oldState, pcb_PTR p) {
+    cpu_t TOD_current;
+    STCK(TOD_current);  /* Get current time */
+    storeState(oldState);
+    currentProcess->p_time += (TOD_current - TOD_start);  /* Update CPU time */
+    readyProcessFront(currentProcess);
+
+    currentProcess = p;
+    TOD_start = TOD_current;
+    sliceHandedOff(TOD_current);
+    loadNextState(&(p->p_s));
+}
+
+/***************************************************************************
+ * Helper function: giveWay
+ * Switches out the current process, which issued the syscall, because a
+ * process it woke sits at a higher level. The caller is queued at the head
+ * of its ready queue, keeping its level and the rest of its slice, and the
+ * scheduler runs.
+ * 
+ * Parameters:
+ * oldState: Pointer to the saved exception state of the caller
+ */
+HIDDEN void giveWay(state_PTR oldState) {
+    cpu_t TOD_current;
+    STCK(TOD_current);  /* Get current time */
+    storeState(oldState);
+    currentProcess->p_time += (TOD_current - TOD_start);  /* Update CPU time */
+    slicePreempted(currentProcess);
+    readyProcessFront(currentProcess);
+    currentProcess = mkEmptyProcQ();
+    scheduler();
 }
 
 /***************************************************************************
  * Function: verhogen (SYS4)
  * Performs V operation on semaphore specified in a1.
- * If processes are blocked on the semaphore, unblocks one.
+ * If processes are blocked on the semaphore, unblocks one, which takes
+ * over the semaphore if it was held. Otherwise the semaphore is released.
+ * The previous holder gives up the priority it inherited through it.
+ * The woken process runs at once if the V hands off, or if it sits at a
+ * higher level than the caller.
  */
 void verhogen() { 
     state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
     int *semAddress = (int *) oldState->s_a1;  
     (*semAddress)++; 
     pcb_PTR p;
+    pcb_PTR oldOwner = semOwner(semAddress);
     if (*semAddress <= 0) {
         /* If processes waiting, unblock one */
         p = removeBlocked(semAddress);  /* Remove first blocked process */
         if (p != NULL) {
-            insertProcQ(&readyQueue, p);  /* Add to ready queue */
+            if (oldOwner != NULL) {
+                /* Hand the semaphore over to the woken process */
+                setSemOwner(semAddress, p);
+                updateInheritance(oldOwner);
+                updateInheritance(p);
+            }
+            currentProcess->p_wokeWaiter = TRUE;
+            if (wantsHandoff(semAddress, p)) {
+                handOff(oldState, p);  /* Run the woken process now */
+            }
+            readyProcess(p);  /* Add to ready queue */
+            if (higherLevelPending(currentProcess)) {
+                giveWay(oldState);  /* The woken process preempts the caller */
+            }
         }
+    } else if (oldOwner != NULL) {
+        /* Nobody waits, so nobody holds the semaphore any more */
+        clearSemOwner(semAddress);
+        updateInheritance(oldOwner);
     }
-    storeState(oldState); 
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    resumeCaller(oldState);  /* Return control to caller */
 }
 
 /***************************************************************************
@@ -301,13 +576,17 @@ void waitIO() {
         /* If semaphore negative, block process */
         storeState(oldState);  
         currentProcess->p_time += (TOD_stop - TOD_start);  /* Update CPU time */
-        insertBlocked(&(deviceSemaphores[semIndex]), currentProcess);  /* Block on device */
+        currentProcess->p_wokeWaiter = FALSE;
+        quantumBlocked(currentProcess);
+        promoteProcess(currentProcess);  /* Favour processes that wait on I/O */
+        insertProcQ(&(deviceQueues[semIndex]), currentProcess);  /* Block on device */
+        currentProcess->p_semAdd = &(deviceSemaphores[semIndex]);
         
         currentProcess = mkEmptyProcQ();  /* Clear current process */
         softBlockCount++;  /* Increment soft block count */
         scheduler();  /* Call scheduler to select next process */
     }
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    resumeCaller(oldState);  /* Return control to caller */
 }
 
 /***************************************************************************
@@ -323,15 +602,16 @@ void getCPUTime() {
     /* Calculate total CPU time: accumulated + current interval */
     oldState->s_v0 = currentProcess->p_time + TOD_current - TOD_start;
 
-    storeState(oldState);  
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    resumeCaller(oldState);  /* Return control to caller */
 }
 
 /***************************************************************************
  * Function: waitClock (SYS7)
  * Blocks the current process until the next interval timer
  * interrupt (100ms). Updates the pseudo-clock semaphore and
- * soft block count.
+ * soft block count. The interval timer only runs while a process
+ * waits for it, so it is armed here for the next tick. As in waitIO,
+ * the waiter goes up one level.
  */
 void waitClock() {
     int TOD_stop;
@@ -342,14 +622,18 @@ void waitClock() {
 
     if (deviceSemaphores[CLOCK] >= 0) {
         /* If semaphore non-negative, no blocking needed */
-        loadNextState(currentProcess->p_s);  
+        resumeCaller(oldState);  
     }
     
     /* Block the process on the pseudo-clock semaphore */
     softBlockCount++;  
     storeState(oldState);  
     currentProcess->p_time += (TOD_stop - TOD_start);  /* Update CPU time */
-    insertBlocked(&(deviceSemaphores[CLOCK]), currentProcess);  /* Block process */
+    currentProcess->p_wokeWaiter = FALSE;
+    quantumBlocked(currentProcess);
+    promoteProcess(currentProcess);  /* Waiting on the clock is waiting on I/O */
+    waitForTick(currentProcess);  /* Block process */
+    armClock();  /* Make sure the next tick comes */
     currentProcess = NULL;  /* Clear current process */
 
     scheduler();  
@@ -363,8 +647,135 @@ void waitClock() {
 void getSupportData() {
     state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
     oldState->s_v0 = (int) (currentProcess->p_supportStruct);  /* Return support pointer */
-    storeState(oldState);  
-    loadNextState(currentProcess->p_s);  /* Return control to caller */
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: setPriority (SYS21)
+ * Sets the priority level of the current process to the level in a1
+ * (0 is the highest, MLFQLEVELS - 1 the lowest). The multi-level feedback
+ * queue keeps adjusting the level from there on.
+ * Places the previous level in v0, or -1 if a1 is not a valid level.
+ */
+void setPriority() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    int prio = oldState->s_a1;
+
+    if (prio < 0 || prio >= MLFQLEVELS) {
+        oldState->s_v0 = ERROR;
+    } else {
+        oldState->s_v0 = currentProcess->p_prio;
+        currentProcess->p_prio = prio;
+    }
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: getPriority (SYS22)
+ * Returns the level the current process is scheduled at, counting any
+ * priority it inherits through the semaphores it holds.
+ * Places the level in v0 register.
+ */
+void getPriority() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    oldState->s_v0 = effectivePrio(currentProcess);
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: getSchedInfo (SYS23)
+ * Returns the scheduling statistic of the current process selected by a1:
+ * its quantum (SCHEDQUANTUM), the number of times it blocked before its
+ * slice ran out (SCHEDYIELDS), the number of times it was preempted
+ * (SCHEDPREEMPTS), or the number of real-time jobs released for it 
+ * (SCHEDJOBS) and deadlines it missed (SCHEDMISSES).
+ * Places the value in v0 register, or -1 if a1 is not a valid selector.
+ */
+void getSchedInfo() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    switch (oldState->s_a1) {
+        case SCHEDQUANTUM: {
+            oldState->s_v0 = currentProcess->p_quantum;
+            break;
+        }
+        case SCHEDYIELDS: {
+            oldState->s_v0 = currentProcess->p_yields;
+            break;
+        }
+        case SCHEDPREEMPTS: {
+            oldState->s_v0 = currentProcess->p_preempts;
+            break;
+        }
+        case SCHEDJOBS: {
+            oldState->s_v0 = currentProcess->p_jobs;
+            break;
+        }
+        case SCHEDMISSES: {
+            oldState->s_v0 = currentProcess->p_misses;
+            break;
+        }
+        default: {
+            oldState->s_v0 = ERROR;
+        }
+    }
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: setTickets (SYS24)
+ * Gives the current process the number of tickets in a1 (0 to MAXTICKETS).
+ * A process holding tickets gets a share of the CPU proportional to them
+ * in the stride class; a process with 0 tickets is scheduled by the MLFQ.
+ * Places the previous number of tickets in v0, or -1 if a1 is invalid.
+ */
+void setTickets() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    oldState->s_v0 = changeTickets(currentProcess, oldState->s_a1);
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: setRealTime (SYS25)
+ * Puts the current process in the real-time class with the period in a1
+ * and the budget per period in a2, both in microseconds. The process is 
+ * admitted only if the utilization of the class stays within 1. A period
+ * of 0 returns the process to the MLFQ.
+ * Places 0 in v0 if the process was admitted, -1 otherwise.
+ */
+void setRealTime() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    oldState->s_v0 = changeRealTime(currentProcess, oldState->s_a1, oldState->s_a2);
+    armTimer();  /* The PLT must not run past the new release */
+    resumeCaller(oldState);  /* Return control to caller */
+}
+
+/***************************************************************************
+ * Function: setHandoff (SYS26)
+ * Turns handoff on V on (a2 TRUE) or off (a2 FALSE) for the semaphore at
+ * address a1. With a1 0, turns it on or off for every process that blocks
+ * on a semaphore right after a V that woke a waiter.
+ * Places 0 in v0, or -1 if HANDOFFMAX semaphores already hand off.
+ */
+void setHandoff() {
+    state_PTR oldState = (state_PTR) BIOSDATAPAGE;  
+    int *semAddress = (int *) oldState->s_a1;
+    int i = handoffIndex(semAddress);
+    oldState->s_v0 = OK;
+
+    if (oldState->s_a1 == 0) {
+        handoffAuto = (oldState->s_a2 != FALSE);
+    } else if (oldState->s_a2 == FALSE) {
+        if (i >= 0) {
+            handoffSems[i] = handoffSems[--handoffCount];
+        }
+    } else if (i < 0) {
+        if (handoffCount == HANDOFFMAX) {
+            oldState->s_v0 = ERROR;
+        } else {
+            handoffSems[handoffCount++] = semAddress;
+        }
+    }
+    resumeCaller(oldState);  /* Return control to caller */
 }
 
 /***************************************************************************
@@ -388,11 +799,18 @@ void passUpOrDie(int passUpCode)
         cpu_t currentTOD;
         STCK(currentTOD);
         currentProcess->p_time += (currentTOD - TOD_start);
-
-        /* Load context from support structure */
-        LDCXT(currentProcess->p_supportStruct->sup_exceptContext[passUpCode].c_stackPtr, 
-              currentProcess->p_supportStruct->sup_exceptContext[passUpCode].c_status, 
-              currentProcess->p_supportStruct->sup_exceptContext[passUpCode].c_pc);
+        TOD_start = currentTOD;  /* The time up to here is charged */
+
+        /* Load context from support structure, as LDCXT would, with the
+           support structure as the handler's argument in a0 so that the
+           handler does not need a SYS8 to find it */
+        context_t *context = &(currentProcess->p_supportStruct->sup_exceptContext[passUpCode]);
+        exceptStatePtr->s_sp = context->c_stackPtr;
+        exceptStatePtr->s_status = context->c_status;
+        exceptStatePtr->s_pc = context->c_pc;
+        exceptStatePtr->s_t9 = context->c_pc;
+        exceptStatePtr->s_a0 = (int) currentProcess->p_supportStruct;
+        loadNextState(exceptStatePtr);
     }
     else {
         /* No support structure - terminate the process */
@@ -422,11 +840,20 @@ void programTrapHandler() {
 /***************************************************************************
  * Function: uTLB_RefillHandler
  * Handles TLB refill exceptions by loading the missing page
- * into the TLB and returning control to the process.
+ * into the TLB and returning control to the process. The kernel info 
+ * page is not in the page table: it gets a global, read-only entry.
  */
 void uTLB_RefillHandler() {
     state_PTR exceptionState = (state_PTR) BIOSDATAPAGE;  
     int vpn = (exceptionState->s_entryHI & VPNMASK) >> VPNSHIFT;  /* Extract VPN */
+
+    if (vpn == (KINFOPAGE >> VPNSHIFT)) {
+        /* The kernel info page: one read-only frame shared by every ASID */
+        setENTRYHI(KINFOPAGE);
+        setENTRYLO(KINFOFRAME | VALIDON | GLOBALON);
+        TLBWR();
+        LDST(exceptionState);
+    }
     vpn %= MAXPAGES;  /* Normalize VPN */
 
     /* Get page table entry from current process */
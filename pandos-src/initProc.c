@@ -94,6 +94,10 @@ HIDDEN void configSupStruct(int id) {
     /* Basic ASID assignment */
     supStructs[id].sup_asid = id;
     supStructs[id].sup_privateSem = 0;
+    supStructs[id].sup_hardFaults = 0;
+    supStructs[id].sup_softFaults = 0;
+    supStructs[id].sup_pageOuts = 0;
+    supStructs[id].sup_dirtyFaults = 0;
     
     /* Configure context for general exceptions */
     supStructs[id].sup_exceptContext[GENERALEXCEPT].c_pc = (memaddr) supGeneralExceptionHandler;
@@ -109,7 +113,7 @@ HIDDEN void configSupStruct(int id) {
     int pg;
     for(pg = 0; pg < MAXPAGES; pg++) {
         supStructs[id].sup_privatePgTbl[pg].entryHI = ALLOFF | ((UPROCSTART + pg) << VPNSHIFT) | (id << ASIDSHIFT);
-        supStructs[id].sup_privatePgTbl[pg].entryLO = ALLOFF | DIRTYON;
+        supStructs[id].sup_privatePgTbl[pg].entryLO = ALLOFF;  /* clean until written */
     }
 
     /* Configure stack page */
@@ -11,6 +11,9 @@
  * the nucleus stack as its stack. The scheduler is then called to start the
  * operating system. 
  * 
+ * Processes waiting on a device or on the pseudo-clock are kept on
+ * deviceQueues, indexed like deviceSemaphores, rather than on the ASL.
+ * 
  * Written by Khoa Ho & Hieu Tran
  * February 2025
  ****************************************************************************/
@@ -18,9 +21,10 @@
 /* Global variables */
 int     processCount;            
 int     softBlockCount;                 
-pcb_PTR readyQueue;               
+pcb_PTR readyQueues[MLFQLEVELS];  /* one ready queue per priority level */
 pcb_PTR currentProcess;          
 int     deviceSemaphores[DEVICE_COUNT];  
+pcb_PTR deviceQueues[DEVICE_COUNT];      /* processes waiting on each device */
 cpu_t   TOD_start;             
 
 void main() {
@@ -42,16 +46,20 @@ void main() {
     /* Initialize nucleus maintained variables */
     processCount = 0;
     softBlockCount = 0;
-    readyQueue = mkEmptyProcQ();
     currentProcess = NULL;
 
-    /* Initialize device semaphores */
     int i;
+    for (i = 0; i < MLFQLEVELS; i++) {
+        readyQueues[i] = mkEmptyProcQ();
+    }
+
+    /* Initialize device semaphores and their wait queues */
     for (i = 0; i < DEVICE_COUNT; i++) {
         deviceSemaphores[i] = 0;
+        deviceQueues[i] = mkEmptyProcQ();
     }
 
-    LDIT(CLOCKINTERVAL);  /* 100ms */
+    startClock();  /* Pseudo-clock ticks every 100ms, while needed */
 
     /* Create and initialize first process */
     pcb_PTR firstProcess = allocPcb();
@@ -70,7 +78,7 @@ void main() {
     firstProcess->p_prnt = NULL;
     
     /* Add to ready queue and update process count */
-    insertProcQ(&readyQueue, firstProcess);
+    readyProcess(firstProcess);
     processCount++;
 
     scheduler();
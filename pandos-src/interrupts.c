@@ -15,76 +15,95 @@
  * Helper functions include:
  * - getDeviceNumber() returns the device number given the device bitmask of the
  * interrupting device.
- * - ackTermInterrupt() acknowledges the terminal interrupt and returns the
- * status code.
+ * - termPending() tells whether a terminal sub-device needs an
+ * acknowledgement.
+ * - ackTermInterrupt() acknowledges and handles both sub-devices of a 
+ * terminal in one pass.
  * - ackDeviceInterrupt() acknowledges the non-terminal interrupt and returns the
  * status code.
  * - handleDevSemaphore() handles the device semaphore and wakes up the blocked
  * process if necessary.
+ * - deferWork() and runDeferredWork() queue completions and handle them.
+ * - preemptCurrent() switches out a process that must give way to one 
+ * that became ready during the interrupt.
+ * 
+ * Device and pseudo-clock waiters sit on deviceQueues, indexed directly by
+ * device index, so no interrupt handler touches the ASL. MLFQ processes
+ * that wait for the pseudo-clock sit on clockQueues instead, one per 
+ * level, and a tick wakes them all by joining each of those onto the 
+ * ready queue of its level, without visiting the processes: a woken 
+ * process still looks blocked on the clock until settleTickWaiter sees 
+ * that the tick it waited for (p_clockGen) has passed.
+ * 
+ * One kernel entry handles every pending line and every pending device on
+ * each line, and leaves through a single exit in interruptHandler, so 
+ * devices that complete together cost one exception rather than one each.
+ * Device interrupts are handled in two stages: the top half only 
+ * acknowledges the device and queues its status on a ring (deferWork), 
+ * with interrupts masked, and the deferred-work pass (runDeferredWork) 
+ * then wakes the waiting processes. The pass runs from the scheduler, 
+ * with interrupts enabled between completions, so the masked part of an
+ * entry is bounded by the acknowledgements alone. An interrupt that comes
+ * in during the pass starts the scheduler again on a fresh kernel stack,
+ * and the pass goes on from the ring.
+ * 
+ * The pseudo-clock is tickless: the interval timer is only armed while
+ * some process waits in SYS7, and is parked otherwise, so an idle system
+ * takes no periodic interrupts. When it is armed, the next tick is taken
+ * from the fixed 100ms schedule that starts at boot, as if the timer had 
+ * never stopped.
  * 
  * Written by Khoa Ho & Hieu Tran
  * February 2025
  ****************************************************************************/
 
+HIDDEN cpu_t clockBase;     /* TOD at which the 100ms tick schedule starts */
+HIDDEN int clockArmed;      /* TRUE while the interval timer is loaded */
+HIDDEN pcb_PTR clockQueues[MLFQLEVELS];  /* MLFQ clock waiters, by level */
+HIDDEN int clockWaiters;                 /* processes on clockQueues */
+HIDDEN unsigned int clockGen;            /* pseudo-clock ticks so far */
+HIDDEN devWork_t devWork[DEVWORKMAX];  /* ring of deferred completions */
+HIDDEN int workHead = 0;               /* oldest entry in devWork */
+HIDDEN int workCount = 0;              /* entries in devWork */
+
+/* Lowest set bit of each 4-bit value, -1 for none */
+HIDDEN const int lowestBit[16] = {-1, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+
 /*****************************************************************************
  * Function: getDeviceNumber
  * 
  * This function returns the device number given the device bitmask. The device
- * bitmask is used to identify the device that caused the interrupt.
+ * bitmask is used to identify the device that caused the interrupt; the 
+ * lowest numbered pending device is returned. The bitmask is decoded a 
+ * nibble at a time through the lowestBit table.
  * Parameters:
  *   devBitmask - The device bitmask.
  * Returns:
  *   The device number. If the device is not found, it returns -1.
  */
 HIDDEN int getDeviceNumber(int devBitmask) {
-    if (devBitmask & DEV0) {
-        return PROCESSOR;
-    } else if (devBitmask & DEV1) {
-        return INTERVALTIMER;
-    } else if (devBitmask & DEV2) {
-        return PLTIMER;
-    } else if (devBitmask & DEV3) {
-        return DISK;
-    } else if (devBitmask & DEV4) {
-        return FLASH;
-    } else if (devBitmask & DEV5) {
-        return NETWORK;
-    } else if (devBitmask & DEV6) {
-        return PRINTER;
-    } else if (devBitmask & DEV7) {
-        return TERMINAL;
+    if (devBitmask & 0x0F) {
+        return lowestBit[devBitmask & 0x0F];
+    } else if (devBitmask & 0xF0) {
+        return 4 + lowestBit[(devBitmask >> 4) & 0x0F];
     }
     return -1; /* device not found */ 
 }
 
 /*****************************************************************************
- * Function: ackTermInterrupt
+ * Function: termPending
  * 
- * This function acknowledges the terminal interrupt and returns the status code.
- * It checks the transmit status first, and if it is not ready, it acknowledges
- * the transmit command. If the transmit status is ready, it checks the receive
- * status and acknowledges the receive command.
+ * This function tells whether a terminal sub-device with the given status
+ * has an interrupt pending: it has completed, or failed, and is neither 
+ * ready nor busy.
  * Parameters:
- *   devRegA - The device register area.
- *   devIndex - The device index.
+ *   status - The status register of the sub-device.
  * Returns:
- *   The status code of the terminal interrupt.
+ *   TRUE if the sub-device needs an acknowledgement, FALSE otherwise.
  */
-HIDDEN int ackTermInterrupt(devregarea_t *devRegA, int *devIndexPtr) {
-	/* Get status code by masking the status register to the right 8 bits */
-	int devIndex = *devIndexPtr;
-    int statusCode = devRegA->devreg[devIndex].t_transm_status & 0x0F;
-    if (statusCode != READY) {
-		/* If the transmit status is not ready, acknowledge the transmit command */
-		statusCode = devRegA->devreg[devIndex].t_transm_status;
-        devRegA->devreg[devIndex].t_transm_command = ACK;
-		*devIndexPtr = devIndex + DEVPERINT;
-    } else {
-		/* If the transmit status is ready, acknowledge the receive command */
-        statusCode = devRegA->devreg[devIndex].t_recv_status;
-        devRegA->devreg[devIndex].t_recv_command = ACK;
-    }
-    return statusCode;
+HIDDEN int termPending(int status) {
+    status &= STATUS_MASK;
+    return (status != READY && status != BUSY);
 }
 
 /*****************************************************************************
@@ -119,25 +138,124 @@ HIDDEN void handleDevSemaphore(int devIndex, int statusCode) {
     pcb_PTR p;
     deviceSemaphores[devIndex]++;
     if (deviceSemaphores[devIndex] <= 0) {
-		/* If there are blocked processes, remove the first one 
-			and insert it into the ready queue */
-        p = removeBlocked(&(deviceSemaphores[devIndex]));
+		/* If there are blocked processes, remove the first one from the
+			device's wait queue and insert it into the ready queue */
+        p = removeProcQ(&(deviceQueues[devIndex]));
         if (p != mkEmptyProcQ()) {
 			/* If process is not null, decrement the soft block count
 				and set the status code  */ 
+            p->p_semAdd = NULL;
             softBlockCount--;
             p->p_s.s_v0 = statusCode;
-            insertProcQ(&readyQueue, p);
+            readyProcess(p);
         }
     }
 }
 
+/*****************************************************************************
+ * Function: deferWork
+ * 
+ * This function queues the completion of a device for the deferred-work 
+ * pass. A (sub)device completes at most once between two passes, so the 
+ * ring cannot fill up; if it ever did, the completion is handled at once.
+ * Parameters:
+ *   devIndex - The device index.
+ *   statusCode - The status code of the interrupt.
+ */
+HIDDEN void deferWork(int devIndex, int statusCode) {
+    if (workCount == DEVWORKMAX) {
+        handleDevSemaphore(devIndex, statusCode);
+        return;
+    }
+    devWork_t *work = &(devWork[(workHead + workCount) % DEVWORKMAX]);
+    work->w_devIndex = devIndex;
+    work->w_status = statusCode;
+    workCount++;
+}
+
+/*****************************************************************************
+ * Function: runDeferredWork
+ * 
+ * This function is the deferred-work pass: it handles the queued device
+ * completions in the order they were acknowledged, waking the process 
+ * waiting on each device. It is called by the scheduler with no current
+ * process. Each completion is taken off the ring and handled with 
+ * interrupts masked, and interrupts are let in between two completions.
+ */
+void runDeferredWork() {
+    while (workCount > 0) {
+        devWork_t *work = &(devWork[workHead]);
+        workHead = (workHead + 1) % DEVWORKMAX;
+        workCount--;
+        handleDevSemaphore(work->w_devIndex, work->w_status);
+
+        /* A pending interrupt is taken here, with the ring consistent */
+        setSTATUS(ALLOFF | IECON | IMON | TEBITON);
+        setSTATUS(ALLOFF | IMON | TEBITON);
+    }
+}
+
+/*****************************************************************************
+ * Function: ackTermInterrupt
+ * 
+ * This function acknowledges both sub-devices of a terminal in one pass,
+ * and queues their completions. The transmitter's status goes to the 
+ * process waiting to write (device index devIndex + DEVPERINT), and the
+ * receiver's to the process waiting to read (device index devIndex). If
+ * neither sub-device looks pending, the receiver is acknowledged, so the
+ * interrupt always clears.
+ * Parameters:
+ *   devRegA - The device register area.
+ *   devIndex - The device index of the terminal's receiver.
+ */
+HIDDEN void ackTermInterrupt(devregarea_t *devRegA, int devIndex) {
+    device_t *term = &(devRegA->devreg[devIndex]);
+    int transmStatus = term->t_transm_status;
+    int recvStatus = term->t_recv_status;
+    int acked = FALSE;
+
+    if (termPending(transmStatus)) {
+        term->t_transm_command = ACK;
+        deferWork(devIndex + DEVPERINT, transmStatus);
+        acked = TRUE;
+    }
+    if (termPending(recvStatus) || !acked) {
+        term->t_recv_command = ACK;
+        deferWork(devIndex, recvStatus);
+    }
+}
+
+/*****************************************************************************
+ * Function: preemptCurrent
+ * 
+ * This function switches out the current process, whose slice is not up,
+ * because a process that comes before it became ready. Its state is saved
+ * from the BIOS data page and it goes back to the head of its ready queue
+ * without being demoted, with the rest of its slice, so that it is the
+ * next of its level to run.
+ */
+HIDDEN void preemptCurrent() {
+	cpu_t stopTod;
+	STCK(stopTod);
+	copyState((state_PTR)BIOSDATAPAGE, &(currentProcess->p_s));
+	currentProcess->p_time += (stopTod - TOD_start);
+	slicePreempted(currentProcess);
+	readyProcessFront(currentProcess);
+	currentProcess = mkEmptyProcQ();
+}
+
 /*****************************************************************************
  * Function: interruptHandler
  * 
- * This function handles the interrupts. It checks the cause of the interrupt
- * and calls the appropriate interrupt handler. It also handles the terminal
- * interrupts by checking the transmit and receive status.
+ * This function handles the interrupts. Every pending line is handled in
+ * the one kernel entry: the device lines first, whose completions are only
+ * acknowledged and queued for the deferred-work pass, then the interval 
+ * timer and the PLT. The handlers only update the queues. The single exit
+ * at the end preempts the current process if completions were queued, so
+ * that the scheduler runs the pass, or if a real-time job released or 
+ * woken here has an earlier deadline, or one of the processes woken or 
+ * boosted here sits at a higher level. It then dispatches a new process if
+ * the current one was switched out, or lets it continue.
  * Parameters:
  *   interruptState - The state of the interrupt.
  */
@@ -148,122 +266,259 @@ void interruptHandler(state_PTR interruptState) {
 	/* Get the device register area to find the device that caused the interrupt */
 	devregarea_t *devrega = (devregarea_t*) RAMBASEADDR;
 
-	if (cause & INTERRUPT_PLT) {
-		pltInterrupt();
+	int lineNo;
+	for (lineNo = DISKINT; lineNo <= TERMINT; lineNo++) {
+		if (cause & (INTERRUPT_DISK << (lineNo - DISKINT))) {
+			nonTimerInterrupt(devrega, lineNo);
+		}
 	}
 	if (cause & INTERRUPT_IT) {
 		itInterrupt();
 	}
-	if (cause & INTERRUPT_DISK) {
-		nonTimerInterrupt(devrega, DISKINT);
-	}
-    if (cause & INTERRUPT_FLASH) {
-		nonTimerInterrupt(devrega, FLASHINT);
-	}
-	if (cause & INTERRUPT_NETW) {
-		nonTimerInterrupt(devrega, NETWINT);
+	if (cause & INTERRUPT_PLT) {
+		pltInterrupt();
 	}
-	if (cause & INTERRUPT_PRINT) {
-		nonTimerInterrupt(devrega, PRNTINT);
+
+	if (currentProcess != mkEmptyProcQ() && (workCount > 0 ||
+		realTimePending(currentProcess) || higherLevelPending(currentProcess))) {
+		/* Completions wait for the pass, or a process woken or a job released
+			here comes before the current one */
+		preemptCurrent();
 	}
-	if (cause & INTERRUPT_TERM) {
-		nonTimerInterrupt(devrega, TERMINT);
+	if (currentProcess == mkEmptyProcQ()) {
+		/* If there is no current process, call the scheduler */
+		scheduler();
 	}
+
+	/* The interrupted process continues, straight from the exception state */
+	loadNextState(interruptState);
 }
 
 /*****************************************************************************
  * Function: nonTimerInterrupt
  * 
- * This function handles the non-timer interrupts. It checks the line number of
- * the interrupt and calls the appropriate function to handle the interrupt.
- * It also handles the terminal interrupts by checking the transmit and receive
- * status.
+ * This function handles the non-timer interrupts of one line. It services
+ * every pending device on the line, lowest numbered first, re-reading the
+ * line's bitmap after each acknowledgement until no device is pending. 
+ * For a terminal, the transmitter and the receiver are both handled at
+ * once.
  * Parameters:
  *   devRegA - The device register area.
  *   lineNo - The line number of the interrupt.
  */
 void nonTimerInterrupt(devregarea_t *devRegA, int lineNo) {
-    int devBitmask = devRegA->interrupt_dev[lineNo - 3];
-    int devNo = getDeviceNumber(devBitmask);
-    state_PTR exceptionState = (state_PTR) BIOSDATAPAGE;
-
-	/* Get the device index of the interrupt */
-    int devIndex = (lineNo - DISKINT) * DEVPERINT + devNo;
-    int statusCode;
-
-    if (lineNo == TERMINT) {
-        statusCode = ackTermInterrupt(devRegA, &devIndex);
-    } else {
-        statusCode = ackDeviceInterrupt(devRegA, devIndex);
-    }
+    int devBitmask;
+    while ((devBitmask = devRegA->interrupt_dev[lineNo - DISKINT]) != 0) {
+        int devNo = getDeviceNumber(devBitmask);
 
-    handleDevSemaphore(devIndex, statusCode);
+        /* Get the device index of the interrupt */
+        int devIndex = (lineNo - DISKINT) * DEVPERINT + devNo;
 
-    if (currentProcess == mkEmptyProcQ()) {
-		/* If there is no current process, set the timer and scheduler */
-        scheduler();
+        if (lineNo == TERMINT) {
+            ackTermInterrupt(devRegA, devIndex);
+        } else {
+            deferWork(devIndex, ackDeviceInterrupt(devRegA, devIndex));
+        }
     }
-
-	/* Copy the state of the current process to the exception state */
-    copyState(exceptionState, &(currentProcess->p_s));
-    loadNextState(currentProcess->p_s);
 }
  
 /*****************************************************************************
  * Function: pltInterrupt
  * 
- * This function handles the PLT timer interrupt. It checks if there is a
- * current process and if so, it copies the state of the current process to the
- * BIOS data page and inserts it into the ready queue. It then sets the timer
- * and calls the scheduler.
+ * This function handles the PLT timer interrupt. If the current process 
+ * still has part of its slice left, the PLT fired for a real-time release
+ * or a boost: the jobs are released, the ready processes are aged, and the
+ * PLT is armed again, and the current process keeps its level and its 
+ * slice, unless the exit of interruptHandler finds that a released job or
+ * a boosted process comes first. Otherwise the slice is used up: it copies
+ * the state of the current process from the BIOS data page and inserts it
+ * into the ready queue. It then acknowledges the timer; interruptHandler 
+ * calls the scheduler.
  */
 void pltInterrupt() {
 	/* Get the current time (when the interrupt occurred) */
 	int stopTod;
 	STCK(stopTod);
 	
+	if (currentProcess != mkEmptyProcQ() && !sliceExpired()) {
+		/* An early wakeup for a release or a boost, not the end of the slice */
+		releaseJobs();
+		ageProcesses();
+		armTimer();
+		return;
+	}
 	if(currentProcess != mkEmptyProcQ()) {
 		/* If there is a current process, copy the state of the current process 
 			to the BIOS data page and insert it into the ready queue */
 		copyState((state_PTR)BIOSDATAPAGE, &(currentProcess->p_s));
 		currentProcess->p_time += (stopTod - TOD_start);
-		insertProcQ(&readyQueue, currentProcess);
+		/* It used its whole time slice, so move it down a level */
+		demoteProcess(currentProcess);
+		quantumExpired(currentProcess);
+		readyProcess(currentProcess);
 		currentProcess = mkEmptyProcQ();
 	}
 
-	/* Acknowledge the interrupt and call the scheduler */
+	/* Acknowledge the interrupt */
 	setTIMER(QUANTUM);
-	scheduler();
+}
+
+/*****************************************************************************
+ * Function: startClock
+ * 
+ * This function starts the 100ms pseudo-clock schedule at the current time.
+ * Nobody waits for a tick yet, so the interval timer is left parked.
+ */
+void startClock() {
+	STCK(clockBase);
+	clockArmed = FALSE;
+	PARKIT();
+
+	int level;
+	for (level = 0; level < MLFQLEVELS; level++) {
+		clockQueues[level] = mkEmptyProcQ();
+	}
+	clockWaiters = 0;
+	clockGen = 0;
+}
+
+/*****************************************************************************
+ * Helper function: isClockQueue
+ * 
+ * Returns TRUE if tp points to one of the clockQueues.
+ */
+HIDDEN int isClockQueue(pcb_PTR *tp) {
+	return (tp >= &(clockQueues[0])) && (tp < &(clockQueues[MLFQLEVELS]));
+}
+
+/*****************************************************************************
+ * Function: waitForTick
+ * 
+ * This function queues p, which is blocking in SYS7, for the next 
+ * pseudo-clock tick. An MLFQ process goes on the clock queue of its 
+ * effective level, and a stride or real-time process on the CLOCK device 
+ * queue, since the heaps of its class cannot be joined in one step.
+ * 
+ * Parameters:
+ *   p - The process to block.
+ */
+void waitForTick(pcb_PTR p) {
+	if (p->p_period > 0 || p->p_tickets > 0) {
+		insertProcQ(&(deviceQueues[CLOCK]), p);
+	} else {
+		insertProcQ(&(clockQueues[effectivePrio(p)]), p);
+		clockWaiters++;
+	}
+	p->p_semAdd = &(deviceSemaphores[CLOCK]);
+	p->p_clockGen = clockGen;
+}
+
+/*****************************************************************************
+ * Function: settleTickWaiter
+ * 
+ * This function finishes the wakeup of p if a tick joined it onto a ready
+ * queue since it blocked: it is no longer blocked on the clock, and it 
+ * belongs to the ready queue of the level of the clock queue it was on. 
+ * It does nothing for any other process, so it can be called on any p 
+ * before its p_semAdd or p_procQ is used.
+ * 
+ * Parameters:
+ *   p - The process.
+ */
+void settleTickWaiter(pcb_PTR p) {
+	if (p->p_semAdd != &(deviceSemaphores[CLOCK]) || p->p_clockGen == clockGen) {
+		return;
+	}
+	p->p_semAdd = NULL;
+	if (isClockQueue(p->p_procQ)) {
+		p->p_procQ = &(readyQueues[p->p_procQ - clockQueues]);
+	}
+}
+
+/*****************************************************************************
+ * Function: outTickWaiter
+ * 
+ * This function takes p off the queue it waits for the next tick on. The 
+ * caller adjusts softBlockCount.
+ * 
+ * Parameters:
+ *   p - The process.
+ * Returns:
+ *   p, or NULL if p is not waiting for a tick.
+ */
+pcb_PTR outTickWaiter(pcb_PTR p) {
+	settleTickWaiter(p);
+	if (p->p_semAdd != &(deviceSemaphores[CLOCK])) {
+		return NULL;
+	}
+	if (isClockQueue(p->p_procQ)) {
+		clockWaiters--;
+	}
+	p->p_semAdd = NULL;
+	return outProcQ(p->p_procQ, p);
+}
+
+/*****************************************************************************
+ * Function: armClock
+ * 
+ * This function is called when a process starts waiting for the next 
+ * pseudo-clock tick. If the interval timer is parked, it is loaded with the
+ * time left until the next tick of the 100ms schedule.
+ */
+void armClock() {
+	if (clockArmed) {
+		return;
+	}
+	cpu_t now;
+	STCK(now);
+	LDIT(CLOCKINTERVAL - ((now - clockBase) % CLOCKINTERVAL));
+	clockArmed = TRUE;
+}
+
+/*****************************************************************************
+ * Function: clockTicks
+ * 
+ * This function returns the number of pseudo-clock intervals from boot to
+ * the given TOD, whether or not the interval timer ran during them.
+ * 
+ * Parameters:
+ *   now - The TOD.
+ */
+unsigned int clockTicks(cpu_t now) {
+	return (unsigned int) (now - clockBase) / CLOCKINTERVAL;
 }
 
 /*****************************************************************************
  * Function: itInterrupt
  * 
- * This function handles the interval timer interrupt. It checks if there is a
- * current process and if so, it copies the state of the current process to the
- * BIOS data page and inserts it into the ready queue. It then sets the timer
- * and calls the scheduler.
+ * This function handles the interval timer interrupt, which is a 
+ * pseudo-clock tick. It wakes up every process waiting for the tick and
+ * parks the interval timer until the next process waits for one. The
+ * current process, if any, continues unless a woken process comes first.
  */
 void itInterrupt() {
-	/* Acknowledge the interrupt by loading the interval timer */
-	LDIT(CLOCKINTERVAL);
-
-	/* Get the first process in the blocked queue */
-	pcb_PTR p = removeBlocked(&(deviceSemaphores[CLOCK])); 
-	while (p != mkEmptyProcQ()) {
-		/* Unblock all pcbs blocked on the Pseudo-clock semaphore. */
-		insertProcQ(&readyQueue, p);
+	/* Acknowledge the interrupt by parking the interval timer */
+	PARKIT();
+	clockArmed = FALSE;
+
+	/* Wake the MLFQ waiters a level at a time, in constant time: they are
+		settled later, when they are next dispatched or looked up */
+	int level;
+	for (level = 0; level < MLFQLEVELS; level++) {
+		joinProcQ(&(readyQueues[level]), &(clockQueues[level]));
+	}
+	softBlockCount -= clockWaiters;
+	clockWaiters = 0;
+	clockGen++;
+
+	/* Stride and real-time waiters go on the heaps of their class */
+	pcb_PTR p;
+	while ((p = removeProcQ(&(deviceQueues[CLOCK]))) != mkEmptyProcQ()) {
+		p->p_semAdd = NULL;
 		softBlockCount--;
-		p = removeBlocked(&(deviceSemaphores[CLOCK]));
+		readyProcess(p);
 	}
 	
 	/* Reset the Pseudo-clock semaphore to zero */
 	(deviceSemaphores[CLOCK]) = 0;
-	
-	if(currentProcess == mkEmptyProcQ()) {
-		scheduler();
-	}
-
-	copyState((state_PTR)BIOSDATAPAGE, &(currentProcess->p_s));
-	loadNextState(currentProcess->p_s);
 }
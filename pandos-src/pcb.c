@@ -8,78 +8,176 @@
 *  Each PCB contains process state information and maintains process
 *  relationships through various pointer fields.
 *
+*  PCBs come from slabs: a static slab of MAXPROC PCBs, plus RAM pages 
+*  above the DMA buffers that are carved into PCBs on demand, up to 
+*  MAXPCBS PCBs in total. Each slab keeps its own free queue.
+*
 *  Key functions:
 *  - allocPcb: allocates and returns a free PCB
-*  - freePcb: returns a PCB to the free list
-*  - initPcbs: initializes the PCB free list
-*  - insertProcQ/removeProcQ: manage process queues
+*  - freePcb: returns a PCB to the free list of its slab
+*  - initPcbs: initializes the PCB slab allocator
+*  - insertProcQ/insertHeadProcQ/removeProcQ: manage process queues
 *  - insertChild/removeChild: manage process hierarchies
 *  - outChild/outProcQ: remove specific processes
 *  - mkEmptyProcQ/emptyProcQ: create/check empty queues
 *  - headProcQ: peek at queue head
+*  - joinProcQ/spliceProcQ: move a whole queue onto the tail of another
 *
 *  Written by Khoa Ho & Hieu Tran
 *  February 2025
 ****************************************************************************/
 
-HIDDEN pcb_PTR pcbFree_h; /* Pointer to the head of the free pcb list */
-HIDDEN pcb_t pcbFree_list[MAXPROC];
+HIDDEN pcb_t pcbFree_list[MAXPROC];			/* PCBs of the static slab */
+HIDDEN pcbSlab_t pcbSlabs[PCBSLABMAX + 1];	/* slab 0 is the static slab */
+HIDDEN pcbSlab_PTR pcbSlab_h;				/* Head of the list of slabs with free PCBs */
+HIDDEN int pcbSlabCount;					/* Number of slabs in use */
+HIDDEN int pcbCount;						/* Number of PCBs in all slabs */
 
 /****************************************************************************
- * Function: freePcb
- * Insert the element pointed to by p onto the pcbFree list. 
- * The pcb is inserted at the head of the list.
+ * Helper function: initSlab
+ * Put the n PCBs starting at base on the free queue of the given slab and 
+ * add the slab to the list of slabs with free PCBs.
+ */
+HIDDEN void initSlab(pcbSlab_PTR slab, pcb_PTR base, int n) {
+	slab->sl_base = base;
+	slab->sl_size = n;
+	slab->sl_free = mkEmptyProcQ();
+
+	int i;
+	for (i = 0; i < n; i++) {
+		insertProcQ(&(slab->sl_free), &(base[i]));
+	}
+	slab->sl_next = pcbSlab_h;
+	pcbSlab_h = slab;
+
+	pcbSlabCount++;
+	pcbCount += n;
+}
+
+/****************************************************************************
+ * Helper function: growPcbs
+ * Carve the next free RAM page above the DMA buffers into a new slab of 
+ * PCBs. The pool stops growing at MAXPCBS PCBs, after PCBSLABMAX pages, or 
+ * when the page would reach the stacks kept just below RAMTOP.
+ * Return TRUE if a slab was added, FALSE otherwise.
+ */
+HIDDEN int growPcbs() {
+	if (pcbSlabCount > PCBSLABMAX || pcbCount >= MAXPCBS) {
+		return FALSE;
+	}
+
+	memaddr ramtop;
+	RAMTOP(ramtop);
+	memaddr page = PCBSLABSTART + ((pcbSlabCount - 1) * PAGESIZE);
+	if (page + PAGESIZE > ramtop - PCBSLABRESERVE) {
+		return FALSE; /* No free RAM left for another slab */
+	}
+
+	initSlab(&(pcbSlabs[pcbSlabCount]), (pcb_PTR) page, 
+		MIN(PAGESIZE / sizeof(pcb_t), MAXPCBS - pcbCount));
+	return TRUE;
+}
+
+/****************************************************************************
+ * Helper function: slabOf
+ * Return the slab the pcb pointed to by p was carved from.
  */
+HIDDEN pcbSlab_PTR slabOf(pcb_PTR p) {
+	if (p >= &(pcbFree_list[0]) && p < &(pcbFree_list[MAXPROC])) {
+		return &(pcbSlabs[0]);
+	}
+	return &(pcbSlabs[(((memaddr) p - PCBSLABSTART) / PAGESIZE) + 1]);
+}
 
+/****************************************************************************
+ * Function: freePcb
+ * Insert the element pointed to by p onto the free list of its slab. 
+ * If the slab had no free PCBs left, it goes back on the list of slabs 
+ * with free PCBs.
+ */
 void freePcb(pcb_PTR p) {
-	insertProcQ(&pcbFree_h, p);
+	pcbSlab_PTR slab = slabOf(p);
+	if (emptyProcQ(slab->sl_free)) {
+		slab->sl_next = pcbSlab_h;
+		pcbSlab_h = slab;
+	}
+	insertProcQ(&(slab->sl_free), p);
 }
 
 /****************************************************************************
  * Function: allocPcb
- * Return NULL if the pcbFree list is empty. Otherwise, remove an element 
- * from the pcbFree list, provide initial values for ALL of the pcbs fields 
- * (i.e. NULL and/or 0) and then return a pointer to the removed element. 
+ * Return NULL if no slab has a free PCB and the pool cannot grow. Otherwise, 
+ * remove an element from the free list of the first slab with free PCBs, 
+ * provide initial values for ALL of the pcbs fields (i.e. NULL and/or 0) 
+ * and then return a pointer to the removed element. 
  * Note: pcbs get reused, so it is important that no previous value persist 
  * in a pcb when it gets reallocated. 
  */
 pcb_PTR allocPcb() {
-	if(pcbFree_h == NULL) {
-		return NULL; /* No available pcb in free list */
+	if (pcbSlab_h == NULL && !growPcbs()) {
+		return NULL; /* No available pcb in any slab */
 	}
 
-	/* Remove a pcb from the free list */
-	pcb_PTR p = removeProcQ(&pcbFree_h);
-	
-	if (pcbFree_h != NULL) 
-	{
-		/* Initialize the values of the PCB */
-		p->p_next = NULL;
-		p->p_prev = NULL;
-		p->p_prnt = NULL;
-		p->p_child = NULL;
-		p->p_next_sib = NULL;
-		p->p_prev_sib = NULL;
-		p->p_semAdd = NULL;
-		p->p_time = 0;
-		p->p_supportStruct = NULL;
+	/* Remove a pcb from the free list of the first slab */
+	pcbSlab_PTR slab = pcbSlab_h;
+	pcb_PTR p = removeProcQ(&(slab->sl_free));
+	if (emptyProcQ(slab->sl_free)) {
+		/* The slab is full, take it off the list */
+		pcbSlab_h = slab->sl_next;
 	}
+	
+	/* Initialize the values of the PCB */
+	p->p_next = NULL;
+	p->p_prev = NULL;
+	p->p_procQ = NULL;
+	p->p_prnt = NULL;
+	p->p_child = NULL;
+	p->p_next_sib = NULL;
+	p->p_prev_sib = NULL;
+	p->p_semAdd = NULL;
+	p->p_time = 0;
+	p->p_prio = 0;
+	p->p_quantum = QUANTUM;
+	p->p_sliceLeft = 0;
+	p->p_yields = 0;
+	p->p_preempts = 0;
+	p->p_wokeWaiter = FALSE;
+	p->p_blocksAfterV = FALSE;
+	p->p_tickets = 0;
+	p->p_stride = 0;
+	p->p_pass = 0;
+	p->p_period = 0;
+	p->p_budget = 0;
+	p->p_util = 0;
+	p->p_release = 0;
+	p->p_deadline = 0;
+	p->p_remaining = 0;
+	p->p_throttled = FALSE;
+	p->p_jobMissed = FALSE;
+	p->p_jobs = 0;
+	p->p_misses = 0;
+	p->p_charged = 0;
+	p->p_heapKey = 0;
+	p->p_heapIdx = -1;
+	p->p_inheritPrio = MLFQLEVELS;
+	p->p_owned = NULL;
+	p->p_clockGen = 0;
+	p->p_supportStruct = NULL;
 	return p;
 }
 
 /****************************************************************************
  * Function: initPcbs
- * Initialize the pcbFree list to contain all the elements of the static 
- * array of MAXPROC pcbs. This method should be called only once during 
- * data structure initialization. 
+ * Initialize the slab allocator with a single slab holding the elements 
+ * of the static array of MAXPROC pcbs. Further slabs are added on demand 
+ * by allocPcb. This method should be called only once during data 
+ * structure initialization. 
  */
 void initPcbs() {
-	pcbFree_h = mkEmptyProcQ();
-
-	int i;
-	for(i = 0; i < MAXPROC; i++) {
-		freePcb(&(pcbFree_list[i]));
-	}
+	pcbSlab_h = NULL;
+	pcbSlabCount = 0;
+	pcbCount = 0;
+	initSlab(&(pcbSlabs[0]), pcbFree_list, MAXPROC);
 }
 
 /****************************************************************************
@@ -106,7 +204,8 @@ int emptyProcQ (pcb_PTR tp) {
  * Insert the pcb pointed to by p into the process queue whose tail- pointer 
  * is pointed to by tp. 
  * Note: The double indirection through tp to allow for the possible updating 
- * of the tail pointer as well.
+ * of the tail pointer as well. tp is also recorded in p so that outProcQ can
+ * unlink p without searching the queue.
  */
 void insertProcQ(pcb_PTR *tp, pcb_PTR p) {
 	if (emptyProcQ(*tp)) {
@@ -121,9 +220,29 @@ void insertProcQ(pcb_PTR *tp, pcb_PTR p) {
 		temp->p_prev = p;
 		p->p_prev->p_next = p;
 	}
+	p->p_procQ = tp; /* Remember which queue p is on */
 	(*tp) = p; /* Update tail pointer */
 }
 
+/****************************************************************************
+ * Function: insertHeadProcQ
+ * Insert the pcb pointed to by p at the head of the process queue whose 
+ * tail-pointer is pointed to by tp, so that it is the next one removed.
+ */
+void insertHeadProcQ(pcb_PTR *tp, pcb_PTR p) {
+	if (emptyProcQ(*tp)) {
+		insertProcQ(tp, p);
+		return;
+	}
+	/* Link p in between the current head and the tail */
+	pcb_PTR temp = (*tp);
+	p->p_next = temp;
+	p->p_prev = temp->p_prev;
+	temp->p_prev = p;
+	p->p_prev->p_next = p;
+	p->p_procQ = tp;
+}
+
 /****************************************************************************
  * Function: removeProcQ
  * Remove the first (i.e. head) element from the process queue whose 
@@ -139,12 +258,14 @@ pcb_PTR removeProcQ(pcb_PTR *tp) {
 	pcb_PTR tail = *tp;
 	if (tail->p_prev == tail) {
 		(*tp) = NULL;
+		tail->p_procQ = NULL;
 		return tail;
 	}
 	else {
 		pcb_PTR remove = tail->p_prev;
 		remove->p_prev->p_next = remove->p_next;
 		remove->p_next->p_prev = remove->p_prev;
+		remove->p_procQ = NULL;
 		return remove;
 	}
 	return NULL;
@@ -156,33 +277,28 @@ pcb_PTR removeProcQ(pcb_PTR *tp) {
  * is pointed to by tp. Update the process queue’s tail pointer if necessary. 
  * If the desired entry is not in the indicated queue (an error condition), 
  * return NULL; otherwise, return p. 
- * Note: p can point to any element of the process queue. 
+ * Note: p can point to any element of the process queue. Membership is 
+ * checked through p->p_procQ, so both the unlink and the wrong-queue 
+ * rejection take constant time.
  */
 pcb_PTR outProcQ(pcb_PTR *tp, pcb_PTR p) {
-	pcb_PTR tail = (*tp);
-	if (emptyProcQ(p)) {
+	if (emptyProcQ(p) || emptyProcQ(*tp) || p->p_procQ != tp) {
+		/* p is not on the queue whose tail is pointed to by tp */
 		return NULL;
 	}
-	if (emptyProcQ(tail)) {
-		return NULL;
-	}
-	pcb_PTR temp = tail->p_next;
-	while (temp != p && temp != tail) {
-		temp = temp->p_next;
-	}
-	if (temp == p) {
+	if (p->p_next == p) {
+		/* p is the only element of the queue */
+		(*tp) = NULL;
+	} else {
 		p->p_next->p_prev = p->p_prev;
 		p->p_prev->p_next = p->p_next;
-		if(temp == tail && tail->p_next == tail) {
-			(*tp) = NULL;
-		}
-		else if(temp == tail) {
-			(*tp) = tail->p_next;
+		if ((*tp) == p) {
+			/* p was the tail, the next newest becomes the tail */
+			(*tp) = p->p_next;
 		}
-		return temp;
-	} else { 
-		return NULL; 
 	}
+	p->p_procQ = NULL;
+	return p;
 }
 
 /****************************************************************************
@@ -198,6 +314,62 @@ pcb_PTR headProcQ(pcb_PTR tp) {
 	return tp->p_prev;
 }
 
+/****************************************************************************
+ * Function: joinProcQ
+ * Move every pcb of the process queue whose tail-pointer is pointed to by 
+ * src onto the tail of the process queue whose tail-pointer is pointed to 
+ * by dest, keeping their order. The queue at src is left empty.
+ * The queues are joined by relinking their ends only, in constant time, 
+ * so the moved pcbs keep src in p_procQ: the caller must re-tag them before
+ * they are used with outProcQ.
+ */
+void joinProcQ(pcb_PTR *dest, pcb_PTR *src) {
+	if (emptyProcQ(*src)) {
+		return;
+	}
+	if (!emptyProcQ(*dest)) {
+		/* Link the old tail of dest to the head of src, and close the ring */
+		pcb_PTR srcTail = (*src);
+		pcb_PTR srcHead = srcTail->p_prev;
+		pcb_PTR destTail = (*dest);
+		pcb_PTR destHead = destTail->p_prev;
+		srcHead->p_next = destTail;
+		destTail->p_prev = srcHead;
+		destHead->p_next = srcTail;
+		srcTail->p_prev = destHead;
+	}
+	(*dest) = (*src);
+	(*src) = mkEmptyProcQ();
+}
+
+/****************************************************************************
+ * Function: spliceProcQ
+ * Move every pcb of the process queue whose tail-pointer is pointed to by 
+ * src onto the tail of the process queue whose tail-pointer is pointed to 
+ * by dest, keeping their order, as joinProcQ does. The moved pcbs are also
+ * re-tagged with dest, so that outProcQ works on them right away.
+ * Return the number of pcbs moved.
+ */
+int spliceProcQ(pcb_PTR *dest, pcb_PTR *src) {
+	if (emptyProcQ(*src)) {
+		return 0;
+	}
+	pcb_PTR srcTail = (*src);
+	pcb_PTR srcHead = srcTail->p_prev;
+	joinProcQ(dest, src);
+
+	/* Walk the moved pcbs from oldest to newest */
+	int moved = 1;
+	pcb_PTR p = srcHead;
+	p->p_procQ = dest;
+	while (p != srcTail) {
+		p = p->p_prev;
+		p->p_procQ = dest;
+		moved++;
+	}
+	return moved;
+}
+
 /****************************************************************************
  * Function: emptyChild
  * Return TRUE if the pcb pointed to by p has no children.
@@ -210,19 +382,18 @@ int emptyChild (pcb_PTR p) {
 /****************************************************************************
  * Function: insertChild
  * Make the pcb pointed to by p a child of the pcb pointed to by prnt.
+ * p becomes the first child; the sibling list is doubly linked so that
+ * both neighbours can be fixed up when a child is later removed.
  */
 void insertChild(pcb_PTR prnt, pcb_PTR p) {
 	if (!emptyProcQ(p)) {
-		if (emptyChild(prnt)) {
-			prnt->p_child = p;
-			p->p_prnt = prnt;
-			p->p_next_sib = NULL;
-			p->p_prev_sib = NULL;
-		} else {
-			p->p_next_sib = prnt->p_child;
-			p->p_next_sib->p_prev_sib = p;
-			prnt->p_child = p;
+		p->p_prnt = prnt;
+		p->p_prev_sib = NULL;
+		p->p_next_sib = prnt->p_child;
+		if (!emptyChild(prnt)) {
+			prnt->p_child->p_prev_sib = p;
 		}
+		prnt->p_child = p;
 	}
 }
 
@@ -233,12 +404,19 @@ void insertChild(pcb_PTR prnt, pcb_PTR p) {
  * Otherwise, return a pointer to this removed first child pcb.
  */
 pcb_PTR removeChild(pcb_PTR p) {
-	if (p->p_child == NULL) {
+	if (emptyChild(p)) {
 		return NULL;
 	}
 	pcb_PTR child = p->p_child;
-	p->p_child = p->p_child->p_next_sib;
+	p->p_child = child->p_next_sib;
+	if (!emptyChild(p)) {
+		/* The next sibling is now the first child */
+		p->p_child->p_prev_sib = NULL;
+	}
 
+	child->p_prnt = NULL;
+	child->p_next_sib = NULL;
+	child->p_prev_sib = NULL;
 	return child;
 }
 
@@ -248,30 +426,25 @@ pcb_PTR removeChild(pcb_PTR p) {
  * If the pcb pointed to by p has no parent, return NULL; 
  * otherwise, return p. 
  * Note: The element pointed to by p need not be the first child of 
- * its parent.
+ * its parent. The sibling back-pointer makes the unlink constant time.
  */
 pcb_PTR outChild(pcb_PTR p) {
 	if ((p->p_prnt) == NULL) {
 		return NULL;
 	}
-	/* If the process is the first child */
-	pcb_PTR prnt = p->p_prnt;
-	pcb_PTR currChild = prnt->p_child;
-	pcb_PTR lastChild = NULL;
-
-	if(currChild == p) {
-		/* If the process is the only child */ 
-		return removeChild(prnt);
+	if (p->p_prev_sib == NULL) {
+		/* If the process is the first child */
+		return removeChild(p->p_prnt);
 	}
 
-	while (currChild != NULL) {
-		if (currChild == p) {
-			lastChild->p_next_sib = p->p_next_sib;
-			lastChild->p_prev_sib = p->p_prev_sib;
-			return p;
-		}
-		lastChild = currChild;
-		currChild = currChild->p_next_sib;
+	/* Link the previous and next siblings to each other */
+	p->p_prev_sib->p_next_sib = p->p_next_sib;
+	if (p->p_next_sib != NULL) {
+		p->p_next_sib->p_prev_sib = p->p_prev_sib;
 	}
-	return NULL;
+
+	p->p_prnt = NULL;
+	p->p_next_sib = NULL;
+	p->p_prev_sib = NULL;
+	return p;
 }
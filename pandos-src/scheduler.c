@@ -4,30 +4,426 @@
  * scheduler.c
  * 
  * This file contains the implementation of the scheduler for the operating
- * system. The scheduler is a simple preemptive round-robin scheduling 
- * algorithm with a time slice value of 5 milliseconds.
+ * system. The scheduler is a preemptive multi-level feedback queue with
+ * MLFQLEVELS round-robin ready queues. Level 0 is served first and has a
+ * time slice of QUANTUM (5 milliseconds); each lower level doubles the
+ * slice. A process that blocks for I/O, or early on a semaphore, moves up
+ * a level, a process that uses up its whole slice moves down a level, and
+ * every AGINGTICKS pseudo-clock intervals all ready processes are boosted
+ * back to level 0. While a process waits below level 0, the PLT is never
+ * armed past the next boost, so that a long slice cannot put it off. A
+ * process that becomes ready at a higher level than the
+ * running one preempts it, and the preempted process goes back to the head
+ * of its level, keeping its level.
+ * A process is queued at its effective level: its own level, or the level
+ * it inherits from processes waiting on a semaphore it holds, if higher.
+ * 
+ * QUANTUM is only where a process's slice starts out. A process that
+ * blocks in less than half of its slice has its quantum halved, and a
+ * process that runs its slice out has it doubled, within MINQUANTUM and
+ * MAXQUANTUM. The slice at a level never exceeds MAXSLICE, however large
+ * the quantum grows.
+ * 
+ * Processes holding tickets form a separate stride scheduling class. Each
+ * such process advances its pass by its stride (STRIDE1 / tickets) for 
+ * every STRIDEUNIT of CPU time it uses, and the process with the lowest 
+ * pass is dispatched next, so the class shares the CPU in proportion to 
+ * tickets. Ready stride processes are kept in a binary min-heap on pass.
+ * The MLFQ as a whole takes part as one more client holding MLFQTICKETS
+ * tickets, charged for the CPU time of every MLFQ dispatch, so a busy 
+ * MLFQ cannot starve the stride class, nor the other way round.
+ * 
+ * Processes that declare a period and a budget form a real-time class, 
+ * which is served before everything else in earliest-deadline-first order.
+ * A new job, with a fresh budget and a deadline one period away, is 
+ * released for each such process when it is due. Releases are checked on
+ * every dispatch, and the PLT never runs past the next one: whatever 
+ * class is running, it is armed with the rest of the slice or the time to
+ * the next timed event, a release or a boost, whichever is shorter. When
+ * it fires early for one, the running process keeps its slice and is only
+ * preempted if a released job or a boosted process comes first. A 
+ * real-time job's slice is what is left of its budget, and a job that
+ * runs out of budget is throttled until its next release. A job that
+ * overruns its budget, or is still running past its deadline when it is
+ * dispatched, counts as a miss. The class admits a process only while the
+ * total utilization stays within 1.
  * 
  * Written by Khoa Ho & Hieu Tran
  * February 2025
  ****************************************************************************/
 
+HIDDEN cpu_t lastBoost = 0;  /* TOD of the last boost to level 0 */
+HIDDEN procHeap_t strideHeap;        /* ready stride processes, keyed on pass */
+HIDDEN unsigned int stridePass = 0;  /* pass the stride class has reached */
+HIDDEN unsigned int mlfqPass = 0;    /* pass of the MLFQ class as a whole */
+HIDDEN int mlfqCharging = FALSE;     /* TRUE while an MLFQ dispatch runs */
+HIDDEN cpu_t mlfqSince;              /* TOD that MLFQ dispatch started */
+HIDDEN cpu_t sliceStart;             /* TOD the running process was dispatched */
+HIDDEN cpu_t sliceEnd;               /* TOD the running process's slice ends */
+HIDDEN procHeap_t edfHeap;           /* ready real-time processes, keyed on deadline */
+HIDDEN pcb_PTR rtTasks[MAXPCBS];     /* every process in the real-time class */
+HIDDEN int rtCount = 0;              /* processes in rtTasks */
+HIDDEN int rtUtil = 0;               /* their total utilization, in UTILSCALE */
+
+/*****************************************************************************
+ * Helper function: keyBefore
+ * 
+ * Returns TRUE if key a comes before key b. Pass values and TOD deadlines
+ * only grow and may wrap around, so they are compared by their difference.
+ */
+HIDDEN int keyBefore(unsigned int a, unsigned int b) {
+    return (int) (a - b) < 0;
+}
+
+/*****************************************************************************
+ * Helper function: heapPlace
+ * 
+ * Stores p in slot i of heap.
+ */
+HIDDEN void heapPlace(procHeap_t *heap, pcb_PTR p, int i) {
+    heap->h_proc[i] = p;
+    p->p_heapIdx = i;
+}
+
+/*****************************************************************************
+ * Helper function: siftUp
+ * 
+ * Moves the process in slot i of heap up past every parent with a later
+ * key.
+ */
+HIDDEN void siftUp(procHeap_t *heap, int i) {
+    pcb_PTR p = heap->h_proc[i];
+    while (i > 0 && keyBefore(p->p_heapKey, heap->h_proc[(i - 1) / 2]->p_heapKey)) {
+        heapPlace(heap, heap->h_proc[(i - 1) / 2], i);
+        i = (i - 1) / 2;
+    }
+    heapPlace(heap, p, i);
+}
+
+/*****************************************************************************
+ * Helper function: siftDown
+ * 
+ * Moves the process in slot i of heap down past every child with an 
+ * earlier key.
+ */
+HIDDEN void siftDown(procHeap_t *heap, int i) {
+    pcb_PTR p = heap->h_proc[i];
+    int child = 2 * i + 1;
+    while (child < heap->h_count) {
+        if (child + 1 < heap->h_count && 
+            keyBefore(heap->h_proc[child + 1]->p_heapKey, heap->h_proc[child]->p_heapKey)) {
+            child++;  /* Take the earlier of the two children */
+        }
+        if (!keyBefore(heap->h_proc[child]->p_heapKey, p->p_heapKey)) {
+            break;
+        }
+        heapPlace(heap, heap->h_proc[child], i);
+        i = child;
+        child = 2 * i + 1;
+    }
+    heapPlace(heap, p, i);
+}
+
+/*****************************************************************************
+ * Helper function: heapInsert
+ * 
+ * Puts p on heap with the given key.
+ */
+HIDDEN void heapInsert(procHeap_t *heap, pcb_PTR p, unsigned int key) {
+    p->p_heapKey = key;
+    heap->h_count++;
+    heapPlace(heap, p, heap->h_count - 1);
+    siftUp(heap, heap->h_count - 1);
+}
+
+/*****************************************************************************
+ * Helper function: heapOut
+ * 
+ * Removes p from heap, filling its slot with the last process.
+ * Returns p, or NULL if p is not on a heap.
+ */
+HIDDEN pcb_PTR heapOut(procHeap_t *heap, pcb_PTR p) {
+    int i = p->p_heapIdx;
+    if (i < 0) {
+        return NULL;
+    }
+    p->p_heapIdx = -1;
+    heap->h_count--;
+    if (i < heap->h_count) {
+        pcb_PTR last = heap->h_proc[heap->h_count];
+        heapPlace(heap, last, i);
+        siftDown(heap, i);
+        siftUp(heap, last->p_heapIdx);
+    }
+    return p;
+}
+
+/*****************************************************************************
+ * Helper function: insertStride
+ * 
+ * Charges p for the CPU time it used since it was last charged, and puts
+ * it on the stride heap. A process whose pass has fallen behind the class
+ * (because it was blocked) restarts from the current pass, so that it 
+ * cannot make up for the time it was not ready.
+ */
+HIDDEN void insertStride(pcb_PTR p) {
+    p->p_pass += p->p_stride * (p->p_time - p->p_charged) / STRIDEUNIT;
+    p->p_charged = p->p_time;
+    if (keyBefore(p->p_pass, stridePass)) {
+        p->p_pass = stridePass;
+    }
+    heapInsert(&strideHeap, p, p->p_pass);
+}
+
+/*****************************************************************************
+ * Helper function: insertEDF
+ * 
+ * Charges the current job of p for the CPU time it used since it was last
+ * charged, and puts p on the real-time heap. If the job has used up its
+ * budget, p is throttled instead, which counts as soft-blocked, until its
+ * next job is released.
+ */
+HIDDEN void insertEDF(pcb_PTR p) {
+    p->p_remaining -= p->p_time - p->p_charged;
+    p->p_charged = p->p_time;
+    if (p->p_remaining > 0) {
+        heapInsert(&edfHeap, p, p->p_deadline);
+        return;
+    }
+    p->p_throttled = TRUE;
+    softBlockCount++;
+}
+
+/*****************************************************************************
+ * Helper function: dropRealTime
+ * 
+ * Takes p, which is on no ready queue, out of the real-time class and 
+ * gives its utilization back.
+ */
+HIDDEN void dropRealTime(pcb_PTR p) {
+    int i = 0;
+    while (i < rtCount && rtTasks[i] != p) {
+        i++;
+    }
+    if (i == rtCount) {
+        return;  /* Not a real-time process */
+    }
+    rtCount--;
+    rtTasks[i] = rtTasks[rtCount];
+    rtUtil -= p->p_util;
+    p->p_period = 0;
+}
+
+/*****************************************************************************
+ * Helper function: nextRelease
+ * 
+ * Returns the time until the next real-time job release in microseconds, 
+ * or XLVALUE if there are no real-time processes.
+ */
+HIDDEN unsigned int nextRelease() {
+    if (rtCount == 0) {
+        return XLVALUE;
+    }
+    cpu_t now;
+    STCK(now);
+    cpu_t wait = rtTasks[0]->p_release - now;
+    int i;
+    for (i = 1; i < rtCount; i++) {
+        wait = MIN(wait, rtTasks[i]->p_release - now);
+    }
+    return MAX(wait, 0);
+}
+
+/*****************************************************************************
+ * Helper function: nextAging
+ * 
+ * Returns the time until the next boost to level 0 in microseconds, or 
+ * XLVALUE if no ready process waits below level 0, as the boost then has
+ * nothing to do.
+ */
+HIDDEN unsigned int nextAging() {
+    int level = 1;
+    while (level < MLFQLEVELS && emptyProcQ(readyQueues[level])) {
+        level++;
+    }
+    if (level == MLFQLEVELS) {
+        return XLVALUE;
+    }
+    cpu_t now;
+    STCK(now);
+    cpu_t wait = lastBoost + AGINGTICKS * CLOCKINTERVAL - now;
+    return MAX(wait, 0);
+}
+
+/*****************************************************************************
+ * Function: armTimer
+ * 
+ * This function loads the PLT with what is left of the running process's
+ * slice, or with the time until the next real-time release or boost if 
+ * that comes first, so that no job is released late, and no boost is put
+ * off, because another process is running.
+ */
+void armTimer() {
+    cpu_t now;
+    STCK(now);
+    cpu_t left = MAX(sliceEnd - now, 0);
+    setTIMER(MIN((unsigned int) left, MIN(nextRelease(), nextAging())));
+}
+
+/*****************************************************************************
+ * Function: sliceExpired
+ * 
+ * This function returns TRUE if the running process has used up its 
+ * slice, or FALSE if the PLT fired before that, for a real-time release or
+ * a boost.
+ */
+int sliceExpired() {
+    cpu_t now;
+    STCK(now);
+    return !keyBefore(now, sliceEnd);
+}
+
+/*****************************************************************************
+ * Helper function: startSlice
+ * 
+ * Starts a slice of the given length, from TOD_start, for the process 
+ * being dispatched, and arms the PLT for it.
+ */
+HIDDEN void startSlice(cpu_t slice) {
+    sliceStart = TOD_start;
+    sliceEnd = TOD_start + slice;
+    armTimer();
+}
+
+/*****************************************************************************
+ * Function: slicePreempted
+ * 
+ * This function is called when the running process p is switched out 
+ * before its slice ran out. An MLFQ process keeps what is left of the 
+ * slice, and is dispatched for no more than that next time, so that being
+ * preempted never earns it a fresh slice.
+ * 
+ * Parameters:
+ *   p - The running process.
+ */
+void slicePreempted(pcb_PTR p) {
+    if (p->p_period > 0 || p->p_tickets > 0) {
+        return;
+    }
+    cpu_t now;
+    STCK(now);
+    p->p_sliceLeft = MAX(sliceEnd - now, 0);
+}
+
+/*****************************************************************************
+ * Function: sliceHandedOff
+ * 
+ * This function is called when the running process hands the rest of its
+ * slice to another at TOD now. The slice keeps its end, but the new 
+ * process's use of it is counted from now.
+ */
+void sliceHandedOff(cpu_t now) {
+    sliceStart = now;
+}
+
+/*****************************************************************************
+ * Helper function: sliceOf
+ * 
+ * Returns the slice of the MLFQ process p: its quantum scaled to its 
+ * effective level, capped at MAXSLICE.
+ */
+HIDDEN cpu_t sliceOf(pcb_PTR p) {
+    return MIN(p->p_quantum << effectivePrio(p), MAXSLICE);
+}
+
+/*****************************************************************************
+ * Helper function: chargeMLFQ
+ * 
+ * Advances the pass of the MLFQ class for the CPU time used since the last
+ * MLFQ dispatch, which has just ended.
+ */
+HIDDEN void chargeMLFQ() {
+    if (mlfqCharging) {
+        cpu_t now;
+        STCK(now);
+        mlfqPass += (STRIDE1 / MLFQTICKETS) * (now - mlfqSince) / STRIDEUNIT;
+        mlfqCharging = FALSE;
+    }
+}
+
 /*****************************************************************************
  * Function: scheduler
  * 
- * This function implements a simple round-robin scheduler. It is called by
- * the operating system to switch between processes.
+ * This function implements the multi-level feedback queue scheduler. It is 
+ * called by the operating system to switch between processes.
  * 
- * The scheduler uses a time slice of 5 milliseconds. If a process does not
- * complete within this time, it is preempted and the next process in the
- * ready queue is scheduled.
+ * The head of the highest non-empty ready queue is dispatched with its own
+ * quantum, scaled to the slice of its level and capped at MAXSLICE. If a
+ * process does not complete within this time, it is preempted and the next
+ * process is scheduled. The stride process with the lowest pass is 
+ * dispatched for one QUANTUM instead when the MLFQ is empty, or when its
+ * pass is below that of the MLFQ class. A class that had nothing ready
+ * restarts from the pass of the other, so that it cannot make up for the
+ * time it was idle. Ready real-time processes come before both: the one
+ * with the earliest deadline runs until its budget is used. An MLFQ 
+ * process that was preempted before its slice ran out gets only the rest
+ * of it. The device completions queued by interrupts are handled first,
+ * with interrupts enabled, so that the processes they wake are considered.
  */
 void scheduler() {
-    if(!emptyProcQ(readyQueue)) {
+    runDeferredWork();
+
+    /* Timed work is done here, so it needs no periodic interrupt */
+    releaseJobs();
+    ageProcesses();
+    chargeMLFQ();
+
+    int level = 0;
+    while (level < MLFQLEVELS && emptyProcQ(readyQueues[level])) {
+        level++;
+    }
+    int strideTurn = (strideHeap.h_count > 0) && (level == MLFQLEVELS ||
+        keyBefore(strideHeap.h_proc[0]->p_pass, mlfqPass));
+
+    if (edfHeap.h_count > 0) {
+        currentProcess = heapOut(&edfHeap, edfHeap.h_proc[0]);
+        STCK(TOD_start);
+        if (!currentProcess->p_jobMissed && 
+            keyBefore(currentProcess->p_deadline, TOD_start)) {
+            /* The job is already late */
+            currentProcess->p_misses++;
+            currentProcess->p_jobMissed = TRUE;
+        }
+        startSlice(currentProcess->p_remaining);
+        loadNextState(&(currentProcess->p_s));
+    }
+    else if (strideTurn) {
+        currentProcess = heapOut(&strideHeap, strideHeap.h_proc[0]);
+        stridePass = currentProcess->p_pass;
+        if (level == MLFQLEVELS && keyBefore(mlfqPass, stridePass)) {
+            mlfqPass = stridePass;  /* The MLFQ was idle */
+        }
+        STCK(TOD_start);
+        startSlice(QUANTUM);
+        loadNextState(&(currentProcess->p_s));
+    }
+    else if(level < MLFQLEVELS) {
         /* Initializes current process */
-        currentProcess = removeProcQ(&readyQueue);
-        setTIMER(QUANTUM);
+        currentProcess = removeProcQ(&(readyQueues[level]));
+        settleTickWaiter(currentProcess);  /* It may have woken on a tick */
+        if (strideHeap.h_count == 0 && keyBefore(stridePass, mlfqPass)) {
+            stridePass = mlfqPass;  /* The stride class is idle */
+        }
+        cpu_t slice = sliceOf(currentProcess);
+        if (currentProcess->p_sliceLeft > 0) {
+            slice = MIN(slice, currentProcess->p_sliceLeft);  /* Resume the slice */
+            currentProcess->p_sliceLeft = 0;
+        }
         STCK(TOD_start);
-        loadNextState(currentProcess->p_s);
+        startSlice(slice);
+        mlfqSince = TOD_start;
+        mlfqCharging = TRUE;
+        loadNextState(&(currentProcess->p_s));
     }
     else {
         if(processCount == 0){
@@ -36,8 +432,9 @@ void scheduler() {
         }
         
         else if(processCount > 0 && softBlockCount > 0) {
-            /* If blocked processes, set timer, status registers, and wait */
-            setTIMER(XLVALUE);
+            /* If blocked processes, set timer, status registers, and wait.
+               The PLT wakes the processor for the next real-time release */
+            setTIMER(nextRelease());
             setSTATUS(ALLOFF | IECON | IMON | TEBITON);
             WAIT();
         }
@@ -48,18 +445,453 @@ void scheduler() {
     }
 }
 
+/*****************************************************************************
+ * Function: effectivePrio
+ * 
+ * This function returns the level a process is scheduled at: the higher of
+ * its own level and the level it has inherited.
+ * 
+ * Parameters:
+ *   p - The process.
+ */
+int effectivePrio(pcb_PTR p) {
+    return MIN(p->p_prio, p->p_inheritPrio);
+}
+
+/*****************************************************************************
+ * Function: readyProcess
+ * 
+ * This function inserts a process at the tail of the ready queue of its
+ * effective priority level, on the stride heap if it holds tickets, or on
+ * the real-time heap if it has a period.
+ * 
+ * Parameters:
+ *   p - The process to make ready.
+ */
+void readyProcess(pcb_PTR p) {
+    if (p->p_period > 0) {
+        insertEDF(p);
+        return;
+    }
+    if (p->p_tickets > 0) {
+        insertStride(p);
+        return;
+    }
+    insertProcQ(&(readyQueues[effectivePrio(p)]), p);
+}
+
+/*****************************************************************************
+ * Function: readyProcessFront
+ * 
+ * This function inserts a process at the head of the ready queue of its
+ * effective priority level, so that it is the next one dispatched there.
+ * Stride and real-time processes have no such place and are readied as
+ * usual.
+ * 
+ * Parameters:
+ *   p - The process to make ready.
+ */
+void readyProcessFront(pcb_PTR p) {
+    if (p->p_period > 0 || p->p_tickets > 0) {
+        readyProcess(p);
+        return;
+    }
+    insertHeadProcQ(&(readyQueues[effectivePrio(p)]), p);
+}
+
+/*****************************************************************************
+ * Function: outReady
+ * 
+ * This function removes a process from the ready queue of its effective 
+ * priority level, or from the heap of its class. A throttled real-time 
+ * process is no longer counted as soft-blocked. A process woken by a tick
+ * is settled first, so that it is found on its ready queue.
+ * 
+ * Parameters:
+ *   p - The process to remove.
+ * Returns:
+ *   p, or NULL if p is not ready or throttled.
+ */
+pcb_PTR outReady(pcb_PTR p) {
+    settleTickWaiter(p);
+    if (p->p_period > 0) {
+        if (p->p_throttled) {
+            p->p_throttled = FALSE;
+            softBlockCount--;
+            return p;
+        }
+        return heapOut(&edfHeap, p);
+    }
+    if (p->p_tickets > 0) {
+        return heapOut(&strideHeap, p);
+    }
+    return outProcQ(&(readyQueues[effectivePrio(p)]), p);
+}
+
+/*****************************************************************************
+ * Function: inheritPrio
+ * 
+ * This function sets the level a process inherits from its waiters
+ * (MLFQLEVELS for none). A ready process is moved to the queue of its new
+ * effective level, and one that waits for a tick to the clock queue of it.
+ * 
+ * Parameters:
+ *   p - The process.
+ *   prio - The inherited level.
+ */
+void inheritPrio(pcb_PTR p, int prio) {
+    if (outReady(p) != NULL) {
+        p->p_inheritPrio = prio;
+        readyProcess(p);
+    } else if (outTickWaiter(p) != NULL) {
+        p->p_inheritPrio = prio;
+        waitForTick(p);
+    } else {
+        p->p_inheritPrio = prio;
+    }
+}
+
+/*****************************************************************************
+ * Function: promoteProcess
+ * 
+ * This function moves a process that is not on a ready queue up one
+ * priority level, unless it is already at the top level.
+ * 
+ * Parameters:
+ *   p - The process to promote.
+ */
+void promoteProcess(pcb_PTR p) {
+    if (p->p_prio > 0) {
+        p->p_prio--;
+    }
+}
+
+/*****************************************************************************
+ * Function: demoteProcess
+ * 
+ * This function moves a process that is not on a ready queue down one
+ * priority level, unless it is already at the bottom level.
+ * 
+ * Parameters:
+ *   p - The process to demote.
+ */
+void demoteProcess(pcb_PTR p) {
+    if (p->p_prio < MLFQLEVELS - 1) {
+        p->p_prio++;
+    }
+}
+
+/*****************************************************************************
+ * Function: quantumBlocked
+ * 
+ * This function is called when the running process blocks. If it used 
+ * less than half of its slice, its quantum is halved. The time used is
+ * counted from the dispatch, not from TOD_start, which is moved on 
+ * whenever CPU time is charged to p_time.
+ * 
+ * Parameters:
+ *   p - The process that blocked.
+ * Returns:
+ *   TRUE if p blocked early, FALSE otherwise.
+ */
+int quantumBlocked(pcb_PTR p) {
+    cpu_t now;
+    STCK(now);
+    p->p_yields++;
+    if (now - sliceStart < (sliceOf(p) >> 1)) {
+        p->p_quantum = MAX(MINQUANTUM, p->p_quantum >> 1);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*****************************************************************************
+ * Function: quantumExpired
+ * 
+ * This function is called when the running process uses up its slice. Its
+ * quantum is doubled, so that it is switched out less often. A real-time 
+ * job whose budget ran out before it finished overran, and cannot meet its
+ * deadline: it counts as a miss. A process that runs its slice out is not
+ * waiting on the processes it wakes, so it loses its handoff hint.
+ * 
+ * Parameters:
+ *   p - The process that was preempted, with p_time up to date.
+ */
+void quantumExpired(pcb_PTR p) {
+    p->p_preempts++;
+    p->p_wokeWaiter = FALSE;
+    p->p_blocksAfterV = FALSE;
+    p->p_quantum = MIN(MAXQUANTUM, p->p_quantum << 1);
+    if (p->p_period > 0 && !p->p_jobMissed &&
+        p->p_remaining <= p->p_time - p->p_charged) {
+        p->p_misses++;
+        p->p_jobMissed = TRUE;
+    }
+}
+
+/*****************************************************************************
+ * Function: changeTickets
+ * 
+ * This function gives a process a number of tickets. With tickets it is
+ * scheduled in the stride class, starting from the current pass; with 0
+ * tickets it goes back to the MLFQ.
+ * 
+ * Parameters:
+ *   p - The process.
+ *   tickets - The number of tickets, 0 to MAXTICKETS.
+ * Returns:
+ *   The number of tickets p held before, or ERROR if tickets is invalid.
+ */
+int changeTickets(pcb_PTR p, int tickets) {
+    if (tickets < 0 || tickets > MAXTICKETS) {
+        return ERROR;
+    }
+    int old = p->p_tickets;
+    pcb_PTR ready = outReady(p);
+    p->p_tickets = tickets;
+    if (tickets > 0) {
+        p->p_stride = STRIDE1 / tickets;
+    }
+    if (old == 0) {
+        /* Joins the stride class */
+        p->p_pass = stridePass;
+        p->p_charged = p->p_time;
+    }
+    if (ready != NULL) {
+        readyProcess(p);
+    }
+    return old;
+}
+
+/*****************************************************************************
+ * Function: changeRealTime
+ * 
+ * This function puts a process in the real-time class with the given 
+ * period and budget per period, in microseconds, and releases its first
+ * job. The process is admitted only if the total utilization of the class
+ * stays within UTILSCALE. A period of 0 takes the process out of the class.
+ * 
+ * Parameters:
+ *   p - The process.
+ *   period - The period, at most MAXPERIOD, or 0.
+ *   budget - The CPU time of one job, at most period.
+ * Returns:
+ *   OK, or ERROR if the parameters are invalid or the class is full.
+ */
+int changeRealTime(pcb_PTR p, cpu_t period, cpu_t budget) {
+    pcb_PTR ready;
+    if (period == 0) {
+        ready = outReady(p);
+        dropRealTime(p);
+        if (ready != NULL) {
+            readyProcess(p);
+        }
+        return OK;
+    }
+    if (period < 0 || period > MAXPERIOD || budget <= 0 || budget > period) {
+        return ERROR;
+    }
+
+    /* Utilization rounded up, so the admitted set never goes over 1 */
+    int util = ((unsigned int) budget * UTILSCALE + period - 1) / period;
+    int oldUtil = (p->p_period > 0) ? p->p_util : 0;
+    if (rtUtil - oldUtil + util > UTILSCALE) {
+        return ERROR;
+    }
+
+    ready = outReady(p);
+    if (p->p_period == 0) {
+        rtTasks[rtCount++] = p;
+    }
+    rtUtil += util - oldUtil;
+    p->p_util = util;
+    p->p_period = period;
+    p->p_budget = budget;
+
+    /* Release the first job now */
+    cpu_t now;
+    STCK(now);
+    p->p_release = now + period;
+    p->p_deadline = now + period;
+    p->p_remaining = budget;
+    p->p_charged = p->p_time;
+    p->p_jobMissed = FALSE;
+    p->p_jobs++;
+    if (ready != NULL) {
+        readyProcess(p);
+    }
+    return OK;
+}
+
+/*****************************************************************************
+ * Function: leaveRealTime
+ * 
+ * This function takes a process that is being terminated, and so is on no
+ * ready queue, out of the real-time class.
+ * 
+ * Parameters:
+ *   p - The process.
+ */
+void leaveRealTime(pcb_PTR p) {
+    if (p->p_period > 0) {
+        dropRealTime(p);
+    }
+}
+
+/*****************************************************************************
+ * Function: releaseJobs
+ * 
+ * This function is called on every dispatch and when the PLT fires for a
+ * release. It releases a new job for every real-time process whose next
+ * release time has come: the job gets a full budget and a deadline one 
+ * period after its release. A throttled process becomes ready again. 
+ * Releases missed because the timers did not fire in time are skipped.
+ * A job released while its process is running is charged only for the
+ * time after the release.
+ * 
+ * Returns:
+ *   TRUE if a job was released, FALSE otherwise.
+ */
+int releaseJobs() {
+    cpu_t now;
+    STCK(now);
+    int released = FALSE;
+    int i;
+    for (i = 0; i < rtCount; i++) {
+        pcb_PTR p = rtTasks[i];
+        if (keyBefore(now, p->p_release)) {
+            continue;
+        }
+        while (!keyBefore(now, p->p_release)) {
+            p->p_release += p->p_period;
+        }
+        p->p_deadline = p->p_release;
+        p->p_remaining = p->p_budget;
+        p->p_charged = p->p_time;
+        if (p == currentProcess) {
+            p->p_charged += now - TOD_start;  /* Not yet in p_time */
+        }
+        p->p_jobMissed = FALSE;
+        p->p_jobs++;
+        if (p->p_throttled) {
+            p->p_throttled = FALSE;
+            softBlockCount--;
+            heapInsert(&edfHeap, p, p->p_deadline);
+        } else if (heapOut(&edfHeap, p) != NULL) {
+            heapInsert(&edfHeap, p, p->p_deadline);  /* New deadline */
+        }
+        released = TRUE;
+    }
+    return released;
+}
+
+/*****************************************************************************
+ * Function: realTimePending
+ * 
+ * This function returns TRUE if a ready real-time job should run instead of
+ * the process p: p is not real-time, or its deadline is later.
+ * 
+ * Parameters:
+ *   p - The running process.
+ */
+int realTimePending(pcb_PTR p) {
+    if (edfHeap.h_count == 0) {
+        return FALSE;
+    }
+    return (p->p_period == 0) || 
+        keyBefore(edfHeap.h_proc[0]->p_deadline, p->p_deadline);
+}
+
+/*****************************************************************************
+ * Function: higherLevelPending
+ * 
+ * This function returns TRUE if a ready MLFQ process sits at a higher level
+ * than the running process p, which should then give way to it. Only MLFQ
+ * processes are preempted this way.
+ * 
+ * Parameters:
+ *   p - The running process.
+ */
+int higherLevelPending(pcb_PTR p) {
+    if (p->p_period > 0 || p->p_tickets > 0) {
+        return FALSE;
+    }
+    int level;
+    for (level = 0; level < effectivePrio(p); level++) {
+        if (!emptyProcQ(readyQueues[level])) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*****************************************************************************
+ * Function: ageProcesses
+ * 
+ * This function is called on every dispatch. Once every AGINGTICKS 
+ * pseudo-clock intervals it moves all ready processes of the lower levels 
+ * to the tail of the top level queue, so that CPU-bound processes cannot 
+ * starve. It goes by the TOD clock, since the pseudo-clock only ticks 
+ * while a process waits for it. armTimer makes the PLT fire when a boost
+ * is due, so it is also called from pltInterrupt.
+ */
+void ageProcesses() {
+    cpu_t now;
+    STCK(now);
+    if (now - lastBoost < (cpu_t) (AGINGTICKS * CLOCKINTERVAL)) {
+        return;
+    }
+    lastBoost = now;
+
+    int level;
+    for (level = 1; level < MLFQLEVELS; level++) {
+        pcb_PTR p = readyQueues[level];
+        if (!emptyProcQ(p)) {
+            do {
+                p->p_prio = 0;
+                p = p->p_next;
+            } while (p != readyQueues[level]);
+            spliceProcQ(&(readyQueues[0]), &(readyQueues[level]));
+        }
+    }
+}
+
+/*****************************************************************************
+ * Helper function: publishInfo
+ * 
+ * This function writes the TOD, the CPU time of the current process and 
+ * the pseudo-clock intervals since boot into the kernel info page, where
+ * U-procs read them at KINFOPAGE without a trap. The values are those of
+ * the last return from the nucleus. ki_seq changes with every update, so
+ * a reader that is switched out half-way through a read can tell, and 
+ * read again.
+ */
+HIDDEN void publishInfo() {
+    kinfo_t *info = (kinfo_t *) KINFOFRAME;
+    cpu_t now;
+    STCK(now);
+    info->ki_seq++;
+    info->ki_tod = now;
+    info->ki_cpuTime = currentProcess->p_time + (now - TOD_start);
+    info->ki_ticks = clockTicks(now);
+}
+
 /*****************************************************************************
  * Function: loadNextState
  * 
  * This function loads the next state of the process to be scheduled. It
- * uses the LDST instruction to load the state of the process.
+ * uses the LDST instruction to load the state in place, wherever it is
+ * kept: in the pcb of a process being dispatched, or in the BIOS data page
+ * for a process that continues after an exception. Every return from the
+ * nucleus to a process goes through here, and updates the kernel info page.
  * 
  * Parameters:
  *   state - The state of the process to be scheduled.
  *
  */
-void loadNextState(state_t state) {
-    LDST(&state);
+void loadNextState(state_PTR state) {
+    publishInfo();
+    LDST(state);
 }
 
 /*****************************************************************************
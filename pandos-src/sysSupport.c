@@ -28,6 +28,14 @@
  *  - SYS11: writeToPrinter – Sends string to assigned printer device
  *  - SYS12: writeToTerminal – Sends string to terminal output
  *  - SYS13: readFromTerminal – Reads a line from terminal input (until EOL)
+ *  - SYS19/SYS20: pSemVirt/vSemVirt – P and V on one of VIRTSEMCOUNT 
+ *    semaphores shared by all U-procs, numbered by a1
+ *  - SYS21-SYS25: priority and scheduling syscalls – Passed on to the 
+ *    nucleus, which applies them to the U-proc itself
+ *  - SYS26: setHandoffVirt – Turns handoff on V on or off for one of the
+ *    shared semaphores, or for U-procs that block right after a V
+ *  - SYS27: getPageFaults – Returns the hard or soft page faults of the 
+ *    U-proc, the pages written back to serve them, or its dirty faults
  *
  *  Each syscall validates user input, manages device semaphores, and uses
  *  LDST to resume user execution upon completion or failure.
@@ -46,6 +54,13 @@ HIDDEN void diskPut(state_t *excState);
 HIDDEN void diskGet(state_t *excState);
 HIDDEN void flashPut(state_t *excState);
 HIDDEN void flashGet(state_t *excState);
+HIDDEN void passToNucleus(state_t *excState);
+HIDDEN void pSemVirt(state_t *excState);
+HIDDEN void vSemVirt(state_t *excState);
+HIDDEN void setHandoffVirt(state_t *excState);
+HIDDEN void getPageFaults(state_t *excState, support_t *supportPtr);
+
+HIDDEN int virtSemaphores[VIRTSEMCOUNT];  /* semaphores shared by U-procs */
 
 /*****************************************************************************
  *  Function: supGeneralExceptionHandler
@@ -53,10 +68,12 @@ HIDDEN void flashGet(state_t *excState);
  *  Handles general exceptions and system calls by checking the cause of the 
  *  exception and dispatches to the appropriate handler 
  *  (supSyscallHandler or supProgramTrapHandler). 
+ * 
+ *  Parameters:
+ *  supportPtr: pointer to the support structure of the current U-proc,
+ *  passed in a0 by the nucleus when it passes the exception up
  */
-void supGeneralExceptionHandler() {
-    /* get support structure */
-    support_t *supportPtr = (support_t*) SYSCALL(GETSUPPORT, 0, 0, 0);
+void supGeneralExceptionHandler(support_t *supportPtr) {
     state_PTR savedExceptionState = &(supportPtr->sup_exceptState[GENERALEXCEPT]);
 
     /* increment PC to next instruction */
@@ -130,6 +147,30 @@ void supSyscallHandler(support_t *supportPtr) {
             delayFacility(supportPtr);  /* SYS18 */
             break;
         }
+        case PSEMVIRT: {
+            pSemVirt(excState);  /* SYS19 */
+            break;
+        }
+        case VSEMVIRT: {
+            vSemVirt(excState);  /* SYS20 */
+            break;
+        }
+        case SETPRIORITY:
+        case GETPRIORITY:
+        case GETSCHEDINFO:
+        case SETTICKETS:
+        case SETREALTIME: {
+            passToNucleus(excState);  /* SYS21 - SYS25 */
+            break;
+        }
+        case SETHANDOFF: {
+            setHandoffVirt(excState);  /* SYS26 */
+            break;
+        }
+        case GETPAGEFAULTS: {
+            getPageFaults(excState, supportPtr);  /* SYS27 */
+            break;
+        }
         default: {
             supProgramTrapHandler();  /* unknown syscall - terminate process */
         }
@@ -179,6 +220,8 @@ void terminateUProc(int* sem) {
  *  Function: getTod (SYS10)
  *
  *  Gets the current time-of-day clock value and stores it in the v0 register.
+ *  The nucleus normally answers SYS10 itself without passing it up (see 
+ *  fastSupportSyscall); this keeps the support level complete.
  * 
  *  Parameters:
  *  excState: pointer to the exception state structure
@@ -192,6 +235,117 @@ void getTod(state_t *excState) {
     excState->s_v0 = tod;
 }
 
+/*****************************************************************************
+ *  Function: pSemVirt (SYS19)
+ *
+ *  Performs a P operation on the shared semaphore numbered a1. The U-proc
+ *  blocks in the nucleus if the semaphore becomes negative. An invalid 
+ *  number terminates the U-proc.
+ * 
+ *  Parameters:
+ *  excState: pointer to the exception state structure
+ */
+void pSemVirt(state_t *excState) {
+    int semNo = excState->s_a1;
+    if (semNo < 0 || semNo >= VIRTSEMCOUNT) {
+        supProgramTrapHandler();
+    }
+    SYSCALL(PASSEREN, (int) &virtSemaphores[semNo], 0, 0);
+}
+
+/*****************************************************************************
+ *  Function: vSemVirt (SYS20)
+ *
+ *  Performs a V operation on the shared semaphore numbered a1, waking a 
+ *  U-proc blocked on it if there is one. An invalid number terminates the
+ *  U-proc.
+ * 
+ *  Parameters:
+ *  excState: pointer to the exception state structure
+ */
+void vSemVirt(state_t *excState) {
+    int semNo = excState->s_a1;
+    if (semNo < 0 || semNo >= VIRTSEMCOUNT) {
+        supProgramTrapHandler();
+    }
+    SYSCALL(VERHOGEN, (int) &virtSemaphores[semNo], 0, 0);
+}
+
+/*****************************************************************************
+ *  Function: setHandoffVirt (SYS26)
+ *
+ *  Turns handoff on V on (a2 TRUE) or off (a2 FALSE) for the shared 
+ *  semaphore numbered a1, or, with a1 -1, for every process that blocks 
+ *  right after a V that woke a waiter. The result of the nucleus SYS26 is
+ *  stored in the v0 register. An invalid number terminates the U-proc.
+ * 
+ *  Parameters:
+ *  excState: pointer to the exception state structure
+ */
+void setHandoffVirt(state_t *excState) {
+    int semNo = excState->s_a1;
+    if (semNo == -1) {
+        excState->s_v0 = SYSCALL(SETHANDOFF, 0, excState->s_a2, 0);
+        return;
+    }
+    if (semNo < 0 || semNo >= VIRTSEMCOUNT) {
+        supProgramTrapHandler();
+    }
+    excState->s_v0 = SYSCALL(SETHANDOFF, (int) &virtSemaphores[semNo], excState->s_a2, 0);
+}
+
+/*****************************************************************************
+ *  Function: getPageFaults (SYS27)
+ *
+ *  Returns the paging statistic of the U-proc selected by a1 in the v0 
+ *  register: its page faults that read flash (FAULTSHARD), those served 
+ *  with no I/O because the page was still in the swap pool (FAULTSSOFT), 
+ *  the pages written back to flash to serve them (FAULTSPAGEOUTS), or the
+ *  first writes to clean pages (FAULTSDIRTY); -1 if a1 is not a valid 
+ *  selector.
+ * 
+ *  Parameters:
+ *  excState: pointer to the exception state structure
+ *  supportPtr: pointer to the support structure of the current U-proc
+ */
+void getPageFaults(state_t *excState, support_t *supportPtr) {
+    switch (excState->s_a1) {
+        case FAULTSHARD: {
+            excState->s_v0 = supportPtr->sup_hardFaults;
+            break;
+        }
+        case FAULTSSOFT: {
+            excState->s_v0 = supportPtr->sup_softFaults;
+            break;
+        }
+        case FAULTSPAGEOUTS: {
+            excState->s_v0 = supportPtr->sup_pageOuts;
+            break;
+        }
+        case FAULTSDIRTY: {
+            excState->s_v0 = supportPtr->sup_dirtyFaults;
+            break;
+        }
+        default: {
+            excState->s_v0 = ERROR;
+        }
+    }
+}
+
+/*****************************************************************************
+ *  Function: passToNucleus (SYS21 - SYS25)
+ *
+ *  Reissues a priority or scheduling syscall to the nucleus. The support 
+ *  level runs on behalf of the U-proc, so the nucleus applies it to the 
+ *  U-proc itself. Its result is stored in the v0 register.
+ * 
+ *  Parameters:
+ *  excState: pointer to the exception state structure
+ */
+void passToNucleus(state_t *excState) {
+    excState->s_v0 = SYSCALL(excState->s_a0, excState->s_a1, excState->s_a2, 0);
+}
+
 /*****************************************************************************
  *  Function: writeToPrinter (SYS11)
  *
@@ -8,6 +8,24 @@
  * (the Pager), managing the swap pool, and performing I/O operations on the 
  * flash device.
  * 
+ * Frames are replaced with the CLOCK (second chance) policy. Each frame of
+ * the swap pool has a reference bit. The clock hand skips a frame that was
+ * referenced since it last passed, clearing its bit and invalidating its
+ * page in the page table and the TLB while leaving the page in its frame.
+ * If the page is used again before the hand comes back, the fault that 
+ * follows is a soft fault: the page is made valid again and its bit set,
+ * with no flash I/O. A frame whose bit is still clear when the hand 
+ * reaches it is the victim.
+ * 
+ * Pages are mapped clean, without the dirty (write enable) bit. The first
+ * write to a page takes a TLB modification exception, which sets the bit,
+ * and only pages with the bit set are written back when they are evicted;
+ * a clean page is the same as its copy on flash.
+ * 
+ * Free frames are kept on a free-frame list, which the pager always uses 
+ * before it runs the clock hand, so no page is evicted while a frame is 
+ * free. The frames of a U-proc go back on the list as soon as it ends.
+ * 
  * Written by Khoa Ho & Hieu Tran
  * April 2025
  *****************************************************************************/
@@ -15,13 +33,17 @@
 /* Local variables */
 HIDDEN swap_t swapPool[POOLSIZE]; /* swap pool table */
 HIDDEN int swapPoolSem; /* semaphore for swap pool */
+HIDDEN int clockHand = 0; /* next frame the clock hand looks at */
+HIDDEN int freeFrames[POOLSIZE]; /* stack of free frames */
+HIDDEN int freeCount; /* frames in freeFrames */
+HIDDEN int fillingFrame = -1; /* frame the pager is filling, or -1 */
 
 /******************************************************************************
  * Function: initSwapStructs
  * 
  * This function initializes the swap pool table entries and the semaphore for
- * the swap pool. It sets all entries in the swap pool to FREEFRAME (-1) and sets
- * the semaphore to 1 (mutex).
+ * the swap pool. It sets all entries in the swap pool to FREEFRAME (-1), puts
+ * every frame on the free-frame list, and sets the semaphore to 1 (mutex).
  */
 void initSwapStructs() {
     int i;
@@ -29,7 +51,10 @@ void initSwapStructs() {
     /* initialize swap pool table entries */
     for (i = 0; i < POOLSIZE; i++) {
         swapPool[i].swap_asid = FREEFRAME;
+        swapPool[i].swap_ref = FALSE;
+        freeFrames[i] = POOLSIZE - 1 - i;
     }
+    freeCount = POOLSIZE;
 
     /* initialize semaphore to 1 (mutex) */
     swapPoolSem = 1;
@@ -41,7 +66,10 @@ void initSwapStructs() {
  * This function handles mutual exclusion for the swap pool. It takes a pointer
  * to the semaphore and either passes it to the P operation or the V operation
  * depending on the value of the 'on' parameter. If 'on' (1), it performs
- * the P operation, otherwise it performs the V operation.
+ * the P operation, otherwise it performs the V operation. The P takes the
+ * semaphore as a mutex, so that its holder inherits the priority of the 
+ * processes waiting for it; semaphores only used to signal are P'd with
+ * a plain SYS3 instead.
  * 
  * Parameters:
  *   on - 1 for P operation, 0 for V operation
@@ -49,7 +77,7 @@ void initSwapStructs() {
  */
 void mutex(int on, int *semAddress) {
     if (on) {
-        SYSCALL(PASSEREN, (unsigned int) semAddress, 0, 0);
+        SYSCALL(PASSEREN, (unsigned int) semAddress, TRUE, 0);
     } else {
         SYSCALL(VERHOGEN, (unsigned int) semAddress, 0, 0);
     }
@@ -100,39 +128,121 @@ HIDDEN void updateTLB(ptEntry_t *ptEntry) {
 /******************************************************************************
  * Function: pickVictim
  * 
- * This function selects a victim frame using round-robin replacement. It
- * increments the next victim index and wraps around if it exceeds the pool size.
+ * This function selects the frame to fill: the top of the free-frame list
+ * if there is a free frame, otherwise a victim chosen by CLOCK replacement,
+ * and is called with interrupts disabled. The clock hand moves round the 
+ * swap pool until it reaches a frame that is free or was not referenced 
+ * since the hand last passed it. Each referenced frame
+ * on the way gets a second chance: its reference bit is cleared and its 
+ * page invalidated, so that the next use of the page shows up as a soft
+ * fault. The hand goes round at most twice.
  * 
  * Returns:
  *   The index of the selected victim frame.
  */
 HIDDEN int pickVictim() {
-    HIDDEN int nextVictim;
-    nextVictim = (nextVictim + 1) % (POOLSIZE);
-    return nextVictim;
+    if (freeCount > 0) {
+        return freeFrames[--freeCount];
+    }
+    while (TRUE) {
+        int frame = clockHand;
+        clockHand = (clockHand + 1) % POOLSIZE;
+        if (swapPool[frame].swap_asid == FREEFRAME || !swapPool[frame].swap_ref) {
+            return frame;
+        }
+
+        /* second chance: leave the page in its frame, but invalid */
+        swapPool[frame].swap_ref = FALSE;
+        swapPool[frame].swap_ptePtr->entryLO &= VALIDOFF;
+        updateTLB(swapPool[frame].swap_ptePtr);
+    }
+}
+
+/******************************************************************************
+ * Function: residentFrame
+ * 
+ * This function finds the frame of the swap pool that still holds a page
+ * of the given process. The page table entry keeps the frame address of 
+ * the page after the clock hand invalidates it, and the frame still holds
+ * the page if its swap pool entry says so.
+ * 
+ * Parameters:
+ *   supportPtr - the support structure of the process
+ *   pageNo - the page number
+ * Returns:
+ *   The index of the frame, or -1 if the page is not in the swap pool.
+ */
+HIDDEN int residentFrame(support_t *supportPtr, int pageNo) {
+    memaddr frameAddr = supportPtr->sup_privatePgTbl[pageNo].entryLO & PFNMASK;
+    if (frameAddr < POOLBASEADDR || frameAddr >= DISKPOOLSTART) {
+        return -1;
+    }
+    int frame = (frameAddr - POOLBASEADDR) / PAGESIZE;
+    if (swapPool[frame].swap_asid != supportPtr->sup_asid || 
+        swapPool[frame].swap_pageNo != pageNo) {
+        return -1;
+    }
+    return frame;
+}
+
+/******************************************************************************
+ * Function: markDirty
+ * 
+ * This function handles a TLB modification exception, the first write to a
+ * clean page: it sets the dirty bit of the page, so that the write can go 
+ * ahead and the page is written back when it is evicted. A write to a page
+ * that is not in the U-proc's page table, such as the read-only kernel 
+ * info page, is a program trap.
+ * 
+ * Parameters:
+ *   supportPtr - the support structure of the U-proc
+ *   excState - the saved exception state
+ */
+HIDDEN void markDirty(support_t *supportPtr, state_PTR excState) {
+    int pageNo = ((excState->s_entryHI & VPNMASK) >> VPNSHIFT) % MAXPAGES;
+    ptEntry_t *pte = &(supportPtr->sup_privatePgTbl[pageNo]);
+    if ((pte->entryHI & VPNMASK) != (excState->s_entryHI & VPNMASK)) {
+        supProgramTrapHandler();
+    }
+
+    mutex(ON, &swapPoolSem);
+    supportPtr->sup_dirtyFaults++;
+
+    toggleInterrupts(OFF);
+    pte->entryLO |= DIRTYON;
+    updateTLB(pte);
+    toggleInterrupts(ON);
+
+    mutex(OFF, &swapPoolSem);
+    LDST(excState);
 }
 
 /******************************************************************************
  * Function: supTlbExceptionHandler (the Pager)
  * 
  * This function handles TLB exceptions. It first checks if the exception is a
- * TLB modification exception, in which case it calls the program trap handler.
+ * TLB modification exception, in which case the page is marked dirty.
  * It then acquires a mutex over the swap pool and checks for a missing page.
- * If a victim frame is occupied, it writes the victim page to the backing store
- * and reads the requested page from the backing store. Finally, it updates the
+ * If the page is still in the swap pool, it is made valid again with no I/O
+ * (a soft fault). Otherwise a victim frame is picked; if it holds a dirty
+ * page, it writes the victim page to the backing store. It then reads the
+ * requested page from the backing store. Finally, it updates the
  * swap pool entry and TLB with the new page table entry.
+ * 
+ * Parameters:
+ *   supportPtr - The support structure of the faulting U-proc, passed in a0
+ *                by the nucleus when it passes the exception up.
  */
-void supTlbExceptionHandler() {
-    /* 1. get support structure pointer */
-    support_t *supportPtr = (support_t *) SYSCALL(GETSUPPORT, 0, 0, 0);
+void supTlbExceptionHandler(support_t *supportPtr) {
+    /* 1. get the saved exception state */
     state_PTR excState = &(supportPtr->sup_exceptState[PGFAULTEXCEPT]);
 
     /* 2. get cause of exception */
     int cause = CAUSE_GET_EXCCODE(excState->s_cause);
     
-    /* 3. if tlb modification exception, program trap */
+    /* 3. if tlb modification exception, mark the page dirty */
     if (cause == TLBMOD) {
-        supProgramTrapHandler();
+        markDirty(supportPtr, excState);
     }
 
     /* 4. get mutex over swap pool */
@@ -141,14 +251,34 @@ void supTlbExceptionHandler() {
     /* 5. get missing page number */
     int missingPage = (excState->s_entryHI & VPNMASK) >> VPNSHIFT;
     missingPage %= MAXPAGES;
+    ptEntry_t *missingPte = &(supportPtr->sup_privatePgTbl[missingPage]);
+
+    /* 6. if the page is still in its frame, only validate it again */
+    int residentIndex = residentFrame(supportPtr, missingPage);
+    if (residentIndex != -1) {
+        swapPool[residentIndex].swap_ref = TRUE;
+        supportPtr->sup_softFaults++;
+
+        toggleInterrupts(OFF);
+        missingPte->entryLO |= VALIDON;
+        updateTLB(missingPte);
+        toggleInterrupts(ON);
+
+        mutex(OFF, &swapPoolSem);
+        LDST(excState);
+    }
+    supportPtr->sup_hardFaults++;
     
-    /* 6. select victim frame using round-robin */
+    /* 7. select a free frame, or a victim frame using CLOCK */
+    toggleInterrupts(OFF);
     int victimIndex = pickVictim();
+    fillingFrame = victimIndex;
+    toggleInterrupts(ON);
     int frameAddr = POOLBASEADDR + (victimIndex * PAGESIZE);
     
-    /* 7. check if victim frame occupied */
+    /* 8. check if victim frame occupied */
     if (swapPool[victimIndex].swap_asid != FREEFRAME) {
-        /* 8. if occupied: */
+        /* 9. if occupied: */
         int victimAsid = swapPool[victimIndex].swap_asid;
         int victimPage = swapPool[victimIndex].swap_pageNo;
         int devNo = victimAsid - 1;
@@ -163,15 +293,18 @@ void supTlbExceptionHandler() {
 
         toggleInterrupts(ON);
         
-        /* (c) write victim page to backing store */
-        int status = flashOperation(FLASH_WRITEBLK, devNo, victimPage, frameAddr);
-        if (status != READY) {
-            /* terminate if flash write fails */
-            supProgramTrapHandler();
+        /* (c) write victim page to backing store, if it was written to */
+        if (swapPool[victimIndex].swap_ptePtr->entryLO & DIRTYON) {
+            int status = flashOperation(FLASH_WRITEBLK, devNo, victimPage, frameAddr);
+            if (status != READY) {
+                /* terminate if flash write fails */
+                supProgramTrapHandler();
+            }
+            supportPtr->sup_pageOuts++;
         }
     }
     
-    /* 9. read requested page from backing store */
+    /* 10. read requested page from backing store */
     int asid = supportPtr->sup_asid;
     int devNo = asid - 1;
     int status = flashOperation(FLASH_READBLK, devNo, missingPage, frameAddr);
@@ -180,25 +313,27 @@ void supTlbExceptionHandler() {
         supProgramTrapHandler();
     }
     
-    /* 10. update swap pool entry */
+    /* 11. update swap pool entry */
     swapPool[victimIndex].swap_asid = asid;
     swapPool[victimIndex].swap_pageNo = missingPage;
-    swapPool[victimIndex].swap_ptePtr = &(supportPtr->sup_privatePgTbl[missingPage]);
+    swapPool[victimIndex].swap_ptePtr = missingPte;
+    swapPool[victimIndex].swap_ref = TRUE;
 
     toggleInterrupts(OFF);
+    fillingFrame = -1;
 
-    /* 11. update page table entry for missing page to valid and dirty */
-    supportPtr->sup_privatePgTbl[missingPage].entryLO = frameAddr | VALIDON | DIRTYON;
+    /* 12. update page table entry for missing page to valid and clean */
+    missingPte->entryLO = frameAddr | VALIDON;
 
-    /* 12. update TLB */
-    updateTLB(&(supportPtr->sup_privatePgTbl[missingPage]));
+    /* 13. update TLB */
+    updateTLB(missingPte);
 
     toggleInterrupts(ON);
 
-    /* 13. release mutex over swap pool */
+    /* 14. release mutex over swap pool */
     mutex(OFF, &swapPoolSem);
 
-    /* 14. return control to retry faulting instruction */
+    /* 15. return control to retry faulting instruction */
     LDST(excState);
 }
 
@@ -207,16 +342,24 @@ void supTlbExceptionHandler() {
  * 
  * This function marks all frames in the swap pool as free for a given ASID.
  * It iterates through the swap pool and sets the ASID of each entry to
- * unoccupied (-1) if it matches the given ASID.
+ * unoccupied (-1) if it matches the given ASID, and puts the frame back on
+ * the free-frame list. A frame the pager is filling is left to the pager,
+ * which has already claimed it.
  * 
  * Parameters:
  *   asid - the ASID of the process whose frames are to be marked free
  */
 void markAllFramesFree(int asid) {
     int i;
+    toggleInterrupts(OFF);
     for (i = 0; i < POOLSIZE; i++) {
         if (swapPool[i].swap_asid == asid) {
             swapPool[i].swap_asid = FREEFRAME;
+            swapPool[i].swap_ref = FALSE;
+            if (i != fillingFrame) {
+                freeFrames[freeCount++] = i;
+            }
         }
     }
+    toggleInterrupts(ON);
 }
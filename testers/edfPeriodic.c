@@ -0,0 +1,78 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  EDF Periodic Tester
+ *
+ *  A periodic task: each job computes fib(16) a few times and then sleeps
+ *  for one second (SYS18). The task first runs JOBS jobs in the ordinary
+ *  round-robin class, then declares a period of one second and a budget of
+ *  BUDGET to the earliest-deadline-first class (SYS25) and runs JOBS more.
+ *  For both halves it reports the worst wake-up lateness, in milliseconds,
+ *  past the end of each one second sleep. For the real-time half it also 
+ *  reports the jobs released and the deadlines missed (SYS23).
+ *  Run it next to CPU-bound testers such as fibEleven or strideShare.
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define JOBS    5
+#define BUDGET  200000    /* 200ms of CPU per one second period */
+
+int fib(int i) {
+    if ((i == 1) || (i == 2))
+        return (1);
+    return (fib(i - 1) + fib(i - 2));
+}
+
+/* runs JOBS jobs and returns the worst wake-up lateness in milliseconds */
+int runJobs() {
+    int job, i;
+    unsigned int due, woke;
+    int late, worst = 0;
+
+    for (job = 0; job < JOBS; job++) {
+        for (i = 0; i < 4; i++) {
+            if (fib(16) != 987) {
+                print(WRITETERMINAL, "ERROR: Recursion problems\n");
+            }
+        }
+        due = SYSCALL(GET_TOD, 0, 0, 0) + SECOND;
+        SYSCALL(DELAY, 1, 0, 0);
+        woke = SYSCALL(GET_TOD, 0, 0, 0);
+        late = (int) (woke - due) / 1000;
+        if (late > worst) {
+            worst = late;
+        }
+    }
+    return worst;
+}
+
+void main() {
+    int worst;
+
+    print(WRITETERMINAL, "EDF Periodic Test starts\n");
+
+    worst = runJobs();
+    print(WRITETERMINAL, "Round-robin worst lateness (ms): ");
+    printNum(WRITETERMINAL, worst);
+
+    if (SYSCALL(SETREALTIME, SECOND, BUDGET, 0) < 0) {
+        print(WRITETERMINAL, "ERROR: SETREALTIME was not admitted\n");
+        SYSCALL(TERMINATE, 0, 0, 0);
+    }
+    worst = runJobs();
+
+    /* Leave the real-time class before reporting */
+    SYSCALL(SETREALTIME, 0, 0, 0);
+
+    print(WRITETERMINAL, "EDF worst lateness (ms): ");
+    printNum(WRITETERMINAL, worst);
+    print(WRITETERMINAL, "EDF jobs released: ");
+    printNum(WRITETERMINAL, SYSCALL(GETSCHEDINFO, SCHEDJOBS, 0, 0));
+    print(WRITETERMINAL, "EDF deadlines missed: ");
+    printNum(WRITETERMINAL, SYSCALL(GETSCHEDINFO, SCHEDMISSES, 0, 0));
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
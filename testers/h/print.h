@@ -7,6 +7,7 @@
 */
 
 extern void print (int device, char *str);
+extern void printNum (int device, int n);
 
 /***************************************************************/
 
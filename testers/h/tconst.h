@@ -26,6 +26,27 @@
 #define DELAY 18
 #define PSEMVIRT 19
 #define VSEMVIRT 20
+/* nucleus scheduling SYS calls, passed on by level 1 */
+#define GETSCHEDINFO 23
+#define SCHEDJOBS 3
+#define SCHEDMISSES 4
+#define SETTICKETS 24
+#define SETREALTIME 25
+#define SETHANDOFF 26
+/* level 1 paging statistics */
+#define GETPAGEFAULTS 27
+#define FAULTSHARD 0
+#define FAULTSSOFT 1
+#define FAULTSPAGEOUTS 2
+#define FAULTSDIRTY 3
+/* kernel info page, read-only, kept up to date by the nucleus */
+#define KINFOPAGE 0xA0000000
+typedef struct kinfo_t {
+	unsigned int ki_seq;		/* changes with every update */
+	unsigned int ki_tod;		/* TOD at the last update */
+	unsigned int ki_cpuTime;	/* CPU time of the running U-proc */
+	unsigned int ki_ticks;		/* pseudo-clock intervals since boot */
+} kinfo_t;
 #define SEG0 0x00000000
 #define SEG1 0x40000000
 #define SEG2 0x80000000
@@ -0,0 +1,75 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  Kernel Info Page Test
+ *
+ *  Reads the time of day READS times from the kernel info page, with no 
+ *  trap, and READS times through SYS10, and reports how long each took in
+ *  microseconds. Every value read from the page must lie between the SYS10
+ *  values taken before and after, and must never go backwards. Also prints
+ *  the CPU time and the pseudo-clock intervals the page reports.
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define READS   1000
+
+/* Reads one field of the page, again if the nucleus updated it meanwhile */
+unsigned int readInfo(volatile kinfo_t *info, volatile unsigned int *field) {
+    unsigned int seq, value;
+    do {
+        seq = info->ki_seq;
+        value = *field;
+    } while (seq != info->ki_seq);
+    return value;
+}
+
+void main() {
+    volatile kinfo_t *info = (volatile kinfo_t *) KINFOPAGE;
+    int i;
+    int ok = TRUE;
+    unsigned int start, stop, tod, last;
+
+    print(WRITETERMINAL, "Kernel Info Page Test starts\n");
+
+    /* Time READS reads of the page */
+    start = SYSCALL(GET_TOD, 0, 0, 0);
+    last = start;
+    for (i = 0; i < READS; i++) {
+        tod = readInfo(info, &(info->ki_tod));
+        if (tod < last) {
+            ok = FALSE;
+        }
+        last = tod;
+    }
+    stop = SYSCALL(GET_TOD, 0, 0, 0);
+    if (last > stop) {
+        ok = FALSE;
+    }
+    print(WRITETERMINAL, "Info page reads, total time (us): ");
+    printNum(WRITETERMINAL, stop - start);
+
+    /* Time READS traps for the same value */
+    start = SYSCALL(GET_TOD, 0, 0, 0);
+    for (i = 0; i < READS; i++) {
+        SYSCALL(GET_TOD, 0, 0, 0);
+    }
+    stop = SYSCALL(GET_TOD, 0, 0, 0);
+    print(WRITETERMINAL, "SYS10 calls, total time (us): ");
+    printNum(WRITETERMINAL, stop - start);
+
+    print(WRITETERMINAL, "CPU time (us): ");
+    printNum(WRITETERMINAL, readInfo(info, &(info->ki_cpuTime)));
+    print(WRITETERMINAL, "Pseudo-clock intervals: ");
+    printNum(WRITETERMINAL, readInfo(info, &(info->ki_ticks)));
+
+    if (ok) {
+        print(WRITETERMINAL, "Kernel Info Page Test concluded\n");
+    } else {
+        print(WRITETERMINAL, "ERROR: info page time out of order\n");
+    }
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
@@ -0,0 +1,59 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  Ping-Pong Benchmark: ping side
+ *
+ *  Run together with pongTest. The two U-procs pass control back and forth
+ *  ROUNDS times through the shared semaphores PING and PONG (SYS19/SYS20), 
+ *  so every round costs two P and two V operations and two context 
+ *  switches in the nucleus. Ping reports the total time and the time of one
+ *  round in microseconds, to compare context switch costs between kernels.
+ *  The rounds are then run again with handoff on V turned on for both 
+ *  semaphores (SYS26), so that each V runs the other side straight away.
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define PING    0       /* V'd by ping, P'd by pong */
+#define PONG    1       /* V'd by pong, P'd by ping */
+#define ROUNDS  1000
+
+/* Times ROUNDS round trips and prints the result */
+void pingPong(char *label) {
+    int i;
+    unsigned int start, stop;
+
+    start = SYSCALL(GET_TOD, 0, 0, 0);
+    for (i = 0; i < ROUNDS; i++) {
+        SYSCALL(VSEMVIRT, PING, 0, 0);
+        SYSCALL(PSEMVIRT, PONG, 0, 0);
+    }
+    stop = SYSCALL(GET_TOD, 0, 0, 0);
+
+    print(WRITETERMINAL, label);
+    print(WRITETERMINAL, "Ping-pong rounds: ");
+    printNum(WRITETERMINAL, ROUNDS);
+    print(WRITETERMINAL, "Total time (us): ");
+    printNum(WRITETERMINAL, stop - start);
+    print(WRITETERMINAL, "Time per round (us): ");
+    printNum(WRITETERMINAL, (stop - start) / ROUNDS);
+}
+
+void main() {
+    print(WRITETERMINAL, "Ping-Pong Benchmark (ping) starts\n");
+
+    /* Wait for pong to get going */
+    SYSCALL(PSEMVIRT, PONG, 0, 0);
+
+    pingPong("Without handoff\n");
+
+    if (SYSCALL(SETHANDOFF, PING, TRUE, 0) < 0 ||
+        SYSCALL(SETHANDOFF, PONG, TRUE, 0) < 0) {
+        print(WRITETERMINAL, "Handoff could not be turned on\n");
+    }
+    pingPong("With handoff\n");
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
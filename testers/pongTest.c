@@ -0,0 +1,34 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  Ping-Pong Benchmark: pong side
+ *
+ *  Run together with pingTest, which does the timing. Pong answers each of
+ *  ping's V on PING with a V on PONG, for both of ping's runs.
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define PING    0       /* V'd by ping, P'd by pong */
+#define PONG    1       /* V'd by pong, P'd by ping */
+#define ROUNDS  1000
+
+void main() {
+    int i;
+
+    print(WRITETERMINAL, "Ping-Pong Benchmark (pong) starts\n");
+
+    /* Tell ping that pong is ready */
+    SYSCALL(VSEMVIRT, PONG, 0, 0);
+
+    for (i = 0; i < 2 * ROUNDS; i++) {
+        SYSCALL(PSEMVIRT, PING, 0, 0);
+        SYSCALL(VSEMVIRT, PONG, 0, 0);
+    }
+
+    print(WRITETERMINAL, "Ping-Pong Benchmark (pong) done\n");
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
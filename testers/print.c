@@ -18,3 +18,24 @@ void print(int device, char *str) {
 		SYSCALL (TERMINATE, 0, 0, 0);
 	}
 }
+
+
+/* Function to print a non-negative number and a newline to a terminal device */
+
+void printNum(int device, int n) {
+
+	char buf[12];
+	char digits[12];
+	int len = 0, i = 0;
+
+	do {
+		digits[len++] = '0' + (n % 10);
+		n = n / 10;
+	} while (n > 0);
+	while (len > 0)
+		buf[i++] = digits[--len];
+	buf[i++] = '\n';
+	buf[i] = EOS;
+	
+	print(device, buf);
+}
@@ -0,0 +1,63 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  Stride Share Tester
+ *
+ *  Built three times, as strideShare1, strideShare2 and strideShare3, which
+ *  hold TICKETS = 1, 2 and 3 tickets in the stride scheduling class (SYS24).
+ *  Each waits a second so that all of them are running, then computes 
+ *  fib(15) over and over for WINDOW seconds, and reports how many rounds it
+ *  completed. Run together, the round counts should be in the ratio 1:2:3,
+ *  so the rounds per ticket should be about the same for all three.
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#ifndef TICKETS
+#define TICKETS 1
+#endif
+
+#define WINDOW 5    /* seconds of measured work */
+
+int fib(int i) {
+    if ((i == 1) || (i == 2))
+        return (1);
+    return (fib(i - 1) + fib(i - 2));
+}
+
+void main() {
+    int rounds = 0;
+    unsigned int end;
+
+    print(WRITETERMINAL, "Stride Share Test starts\n");
+
+    if (SYSCALL(SETTICKETS, TICKETS, 0, 0) < 0) {
+        print(WRITETERMINAL, "ERROR: SETTICKETS failed\n");
+        SYSCALL(TERMINATE, 0, 0, 0);
+    }
+
+    /* Let the other share testers start and get their tickets */
+    SYSCALL(DELAY, 1, 0, 0);
+
+    end = SYSCALL(GET_TOD, 0, 0, 0) + WINDOW * SECOND;
+    while (SYSCALL(GET_TOD, 0, 0, 0) < end) {
+        if (fib(15) != 610) {
+            print(WRITETERMINAL, "ERROR: Recursion problems\n");
+        }
+        rounds++;
+    }
+
+    /* Back to the MLFQ so that the report is not held up */
+    SYSCALL(SETTICKETS, 0, 0, 0);
+
+    print(WRITETERMINAL, "Tickets: ");
+    printNum(WRITETERMINAL, TICKETS);
+    print(WRITETERMINAL, "Rounds of fib(15): ");
+    printNum(WRITETERMINAL, rounds);
+    print(WRITETERMINAL, "Rounds per ticket: ");
+    printNum(WRITETERMINAL, rounds / TICKETS);
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
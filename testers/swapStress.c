@@ -30,6 +30,14 @@ void main () {
 
 	if (corrupt == FALSE)
 		print(WRITETERMINAL, "swapTest ok: data survived swapper\n");
+
+	/* report how the pager served this program */
+	print(WRITETERMINAL, "swapTest hard faults: ");
+	printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSHARD, 0, 0));
+	print(WRITETERMINAL, "swapTest soft faults: ");
+	printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSSOFT, 0, 0));
+	print(WRITETERMINAL, "swapTest page-outs: ");
+	printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSPAGEOUTS, 0, 0));
 	
 	/* try to access segment ksegOS Should cause termination */
 	/* i = getSTATUS(); */
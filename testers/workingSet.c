@@ -0,0 +1,70 @@
+#include "h/localLibumps.h"
+#include "h/tconst.h"
+#include "h/print.h"
+
+/*****************************************************************************
+ *  Working Set Test
+ *
+ *  A paging workload with a hot working set and a cold sweep. Each round 
+ *  writes to the HOTPAGES hot pages many times and then to one of the 
+ *  COLDPAGES cold pages, so the cold pages are touched once per sweep. Run
+ *  as all 8 U-procs, alone or mixed with swapStress, the swap pool is much
+ *  smaller than all the pages in use. A replacement policy that keeps the
+ *  hot pages resident needs fewer hard faults. The data is checked at the 
+ *  end, and the hard and soft faults, page-outs and first writes to clean
+ *  pages are reported (SYS27).
+ * 
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define HOTSTART    20      /* first hot page of kuseg */
+#define HOTPAGES    2
+#define COLDSTART   22      /* first cold page of kuseg */
+#define COLDPAGES   6
+#define ROUNDS      60      /* a multiple of COLDPAGES */
+#define HOTWRITES   50      /* writes to each hot page per round */
+
+void main() {
+    int i, j, k;
+    int corrupt = FALSE;
+
+    print(WRITETERMINAL, "Working Set Test starts\n");
+
+    for (i = 0; i < ROUNDS; i++) {
+        for (j = 0; j < HOTWRITES; j++) {
+            for (k = 0; k < HOTPAGES; k++) {
+                *(int *)(SEG2 + ((HOTSTART + k) * PAGESIZE)) = i;
+            }
+        }
+        *(int *)(SEG2 + ((COLDSTART + (i % COLDPAGES)) * PAGESIZE)) = i;
+    }
+
+    /* each page holds the last round that wrote to it */
+    for (k = 0; k < HOTPAGES; k++) {
+        if (*(int *)(SEG2 + ((HOTSTART + k) * PAGESIZE)) != ROUNDS - 1) {
+            corrupt = TRUE;
+        }
+    }
+    for (k = 0; k < COLDPAGES; k++) {
+        if (*(int *)(SEG2 + ((COLDSTART + k) * PAGESIZE)) != ROUNDS - COLDPAGES + k) {
+            corrupt = TRUE;
+        }
+    }
+
+    print(WRITETERMINAL, "Hard faults: ");
+    printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSHARD, 0, 0));
+    print(WRITETERMINAL, "Soft faults: ");
+    printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSSOFT, 0, 0));
+    print(WRITETERMINAL, "Page-outs: ");
+    printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSPAGEOUTS, 0, 0));
+    print(WRITETERMINAL, "Dirty faults: ");
+    printNum(WRITETERMINAL, SYSCALL(GETPAGEFAULTS, FAULTSDIRTY, 0, 0));
+
+    if (corrupt) {
+        print(WRITETERMINAL, "Working Set Test error: data corrupted\n");
+    } else {
+        print(WRITETERMINAL, "Working Set Test concluded\n");
+    }
+
+    SYSCALL(TERMINATE, 0, 0, 0);
+}
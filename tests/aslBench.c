@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#undef NULL
+
+#include "../h/asl.h"
+#include "../h/pcb.h"
+
+/*****************************************************************************
+ *  ASL Host Benchmark
+ *
+ *  Runs asl.c on the build host and measures the cost of the ASL for 20,
+ *  200 and 2000 active semaphores. For each size, one process is blocked
+ *  on every semaphore, and then:
+ *  - lookup: headBlocked on a semaphore picked at random;
+ *  - P/V: insertBlocked of a second process on a random active semaphore,
+ *    followed by outBlocked and removeBlocked of it, as a blocking P and a
+ *    waking V do;
+ *  are each repeated ROUNDS times and reported in nanoseconds per call.
+ *  The kernel has at most MAXSEMD descriptors, so the benchmark is built
+ *  with a larger MAXSEMD (see the Makefile). Exits with status 1 if the
+ *  ASL ever returns the wrong process.
+ *
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define MAXACTIVE   2000      /* largest number of active semaphores */
+#define ROUNDS      2000000   /* calls timed for each size */
+
+HIDDEN int sems[MAXACTIVE];
+HIDDEN pcb_t blocked[MAXACTIVE];
+HIDDEN pcb_t extra;
+HIDDEN int picks[ROUNDS];
+HIDDEN const int sizes[] = {20, 200, 2000};
+
+/*****************************************************************************
+ * Helper function: nsSince
+ * Returns the nanoseconds per call of n calls started at start.
+ */
+HIDDEN double nsSince(struct timespec *start, int n) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return ((end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec)) / n;
+}
+
+int main() {
+    int errors = 0;
+    int s;
+    int i;
+
+    printf("%8s %12s %12s\n", "active", "lookup ns", "P/V ns");
+    for (s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++) {
+        int n = sizes[s];
+        initASL();
+        for (i = 0; i < n; i++) {
+            errors += insertBlocked(&sems[i], &blocked[i]);
+        }
+        srand(n);
+        for (i = 0; i < ROUNDS; i++) {
+            picks[i] = rand() % n;
+        }
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < ROUNDS; i++) {
+            if (headBlocked(&sems[picks[i]]) != &blocked[picks[i]]) {
+                errors++;
+            }
+        }
+        double lookup = nsSince(&start, ROUNDS);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < ROUNDS; i++) {
+            int *semAdd = &sems[picks[i]];
+            errors += insertBlocked(semAdd, &extra);
+            if (outBlocked(&extra) != &extra) {
+                errors++;
+            }
+            if (removeBlocked(semAdd) != &blocked[picks[i]]) {
+                errors++;
+            }
+            insertBlocked(semAdd, &blocked[picks[i]]);  /* Put it back */
+        }
+        double pv = nsSince(&start, ROUNDS);
+
+        printf("%8d %12.1f %12.1f\n", n, lookup, pv);
+    }
+
+    if (errors > 0) {
+        printf("aslBench: %d wrong results\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+#undef NULL
+
+#include "../h/pcb.h"
+
+/*****************************************************************************
+ *  PCB Host Test
+ *
+ *  Runs pcb.c on the build host, outside of uMPS3, and checks:
+ *  - the slab allocator: the pool grows page by page, up to MAXPCBS PCBs
+ *    or PCBSLABMAX pages, every PCB comes back fully reset, and freed PCBs
+ *    are handed out again;
+ *  - the process queues: insertProcQ, insertHeadProcQ, removeProcQ,
+ *    outProcQ (including the wrong-queue rejection), joinProcQ and
+ *    spliceProcQ;
+ *  - the process trees: trees of TREESIZE nodes are built with random
+ *    parents and torn down again with outChild and removeChild, checking
+ *    every sibling list, and the time taken is reported.
+ *  The slab allocator reads RAMTOP from the bus register area and carves
+ *  RAM above the DMA buffers, so both are mapped at their uMPS3 addresses.
+ *  Exits with status 0 if every check passed.
+ *
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define TREESIZE    5000     /* nodes in each tree */
+#define TREEROUNDS  200      /* trees built and torn down */
+#define QUEUESIZE   100      /* pcbs on the test queues */
+#define FAKERAMSIZE 0x80000  /* RAM mapped at RAMSTART */
+
+HIDDEN int failures = 0;
+HIDDEN pcb_t treeNodes[TREESIZE];
+HIDDEN pcb_t queueNodes[QUEUESIZE];
+
+/*****************************************************************************
+ * Helper function: check
+ * Reports a failed check.
+ */
+HIDDEN void check(int cond, char *what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/*****************************************************************************
+ * Helper function: mapAt
+ * Maps size bytes of zeroed memory at addr. Returns FALSE if addr is not
+ * free on this host.
+ */
+HIDDEN int mapAt(memaddr addr, unsigned int size) {
+    void *p = mmap((void *) (unsigned long) addr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == (void *) (unsigned long) addr;
+}
+
+/*****************************************************************************
+ * Helper function: testSlabs
+ * Allocates every PCB the pool can hand out, frees a third of them and
+ * allocates them again.
+ */
+HIDDEN void testSlabs() {
+    static pcb_PTR got[MAXPCBS + 1];
+    int n = 0;
+    int i;
+
+    initPcbs();
+    while (n <= MAXPCBS && (got[n] = allocPcb()) != NULL) {
+        pcb_PTR p = got[n];
+        check(p->p_next == NULL && p->p_procQ == NULL && p->p_prnt == NULL &&
+              p->p_child == NULL && p->p_semAdd == NULL && p->p_heapIdx == -1 &&
+              p->p_quantum == QUANTUM && p->p_inheritPrio == MLFQLEVELS &&
+              p->p_clockGen == 0 && p->p_sliceLeft == 0,
+              "allocPcb resets every field");
+        p->p_time = 1;  /* Dirty it, to catch a pcb handed out twice */
+        p->p_semAdd = (int *) p;
+        n++;
+    }
+    /* PCBSLABMAX pages on top of the static slab, capped at MAXPCBS */
+    int cap = MIN(MAXPCBS, MAXPROC + PCBSLABMAX * (int) (PAGESIZE / sizeof(pcb_t)));
+    check(n == cap, "the pool grows to its full size");
+
+    int freed = 0;
+    for (i = 0; i < n; i += 3) {
+        freePcb(got[i]);
+        freed++;
+    }
+    int again = 0;
+    pcb_PTR p;
+    while ((p = allocPcb()) != NULL) {
+        check(p->p_time == 0 && p->p_semAdd == NULL, "a reused pcb is reset");
+        again++;
+    }
+    check(again == freed, "freed pcbs are handed out again");
+    printf("slabs: %d pcbs, %d freed and reallocated\n", n, freed);
+}
+
+/*****************************************************************************
+ * Helper function: testQueues
+ * Exercises the process queue operations on QUEUESIZE pcbs.
+ */
+HIDDEN void testQueues() {
+    pcb_PTR q = mkEmptyProcQ();
+    pcb_PTR other = mkEmptyProcQ();
+    int i;
+
+    check(emptyProcQ(q) && removeProcQ(&q) == NULL, "a new queue is empty");
+    for (i = 1; i < QUEUESIZE; i++) {
+        insertProcQ(&q, &queueNodes[i]);
+    }
+    insertHeadProcQ(&q, &queueNodes[0]);
+    check(headProcQ(q) == &queueNodes[0], "insertHeadProcQ puts p first");
+    check(q == &queueNodes[QUEUESIZE - 1], "insertHeadProcQ keeps the tail");
+
+    /* Take out every odd pcb, from wherever it is */
+    for (i = 1; i < QUEUESIZE; i += 2) {
+        check(outProcQ(&other, &queueNodes[i]) == NULL, "outProcQ rejects the wrong queue");
+        check(outProcQ(&q, &queueNodes[i]) == &queueNodes[i], "outProcQ removes p");
+        check(outProcQ(&q, &queueNodes[i]) == NULL, "outProcQ rejects a removed pcb");
+        insertProcQ(&other, &queueNodes[i]);
+    }
+
+    /* Even pcbs, then odd ones, all in order */
+    check(spliceProcQ(&q, &other) == QUEUESIZE / 2, "spliceProcQ counts the moved pcbs");
+    check(emptyProcQ(other), "spliceProcQ empties the source");
+    for (i = 0; i < QUEUESIZE; i++) {
+        int want = (i < QUEUESIZE / 2) ? 2 * i : 2 * (i - QUEUESIZE / 2) + 1;
+        check(queueNodes[want].p_procQ == &q, "moved pcbs belong to the new queue");
+        check(removeProcQ(&q) == &queueNodes[want], "the queue keeps FIFO order");
+    }
+    check(emptyProcQ(q), "the queue is empty again");
+
+    /* joinProcQ moves pcbs the same way, onto an empty queue too, but 
+       leaves their p_procQ tags alone */
+    for (i = 0; i < QUEUESIZE; i++) {
+        insertProcQ((i < QUEUESIZE / 2) ? &other : &q, &queueNodes[i]);
+    }
+    pcb_PTR joined = mkEmptyProcQ();
+    joinProcQ(&joined, &other);
+    joinProcQ(&joined, &q);
+    check(emptyProcQ(other) && emptyProcQ(q), "joinProcQ empties the source");
+    check(queueNodes[0].p_procQ == &other && queueNodes[QUEUESIZE - 1].p_procQ == &q,
+          "joinProcQ does not re-tag the moved pcbs");
+    for (i = 0; i < QUEUESIZE; i++) {
+        check(removeProcQ(&joined) == &queueNodes[i], "joinProcQ keeps FIFO order");
+    }
+    check(emptyProcQ(joined), "the joined queue is empty again");
+}
+
+/*****************************************************************************
+ * Helper function: checkChildren
+ * Checks the sibling list of p in both directions. Returns its length.
+ */
+HIDDEN int checkChildren(pcb_PTR p) {
+    int count = 0;
+    pcb_PTR prev = NULL;
+    pcb_PTR child = p->p_child;
+    while (child != NULL) {
+        check(child->p_prnt == p, "every child points to its parent");
+        check(child->p_prev_sib == prev, "the sibling back-pointers match");
+        prev = child;
+        child = child->p_next_sib;
+        count++;
+    }
+    return count;
+}
+
+/*****************************************************************************
+ * Helper function: testTrees
+ * Builds TREEROUNDS random trees of TREESIZE nodes and tears them down:
+ * every other node is taken out of the middle of its sibling list with
+ * outChild, and the rest with removeChild.
+ */
+HIDDEN void testTrees() {
+    int round;
+    int i;
+    clock_t start = clock();
+
+    srand(1);
+    for (round = 0; round < TREEROUNDS; round++) {
+        for (i = 0; i < TREESIZE; i++) {
+            treeNodes[i].p_prnt = NULL;
+            treeNodes[i].p_child = NULL;
+            treeNodes[i].p_next_sib = NULL;
+            treeNodes[i].p_prev_sib = NULL;
+        }
+        for (i = 1; i < TREESIZE; i++) {
+            insertChild(&treeNodes[rand() % i], &treeNodes[i]);
+        }
+
+        int nodes = 1;
+        for (i = 0; i < TREESIZE; i++) {
+            nodes += checkChildren(&treeNodes[i]);
+        }
+        check(nodes == TREESIZE, "the tree holds every node");
+
+        for (i = 1; i < TREESIZE; i += 2) {
+            check(outChild(&treeNodes[i]) == &treeNodes[i], "outChild removes p");
+            check(treeNodes[i].p_prnt == NULL && treeNodes[i].p_next_sib == NULL &&
+                  treeNodes[i].p_prev_sib == NULL, "outChild clears the tree links");
+        }
+        for (i = 0; i < TREESIZE; i += 2) {
+            checkChildren(&treeNodes[i]);
+        }
+        for (i = 0; i < TREESIZE; i++) {
+            while (removeChild(&treeNodes[i]) != NULL) {
+                checkChildren(&treeNodes[i]);
+            }
+        }
+        for (i = 0; i < TREESIZE; i++) {
+            check(emptyChild(&treeNodes[i]), "every node is childless");
+        }
+        check(outChild(&treeNodes[0]) == NULL, "outChild of the root fails");
+    }
+    printf("trees: %d trees of %d nodes in %.3f s\n", TREEROUNDS, TREESIZE,
+           (double) (clock() - start) / CLOCKS_PER_SEC);
+}
+
+int main() {
+    if (!mapAt(RAMBASEADDR, PAGESIZE) || !mapAt(RAMSTART, FAKERAMSIZE)) {
+        printf("FAILED: cannot map the uMPS3 RAM layout on this host\n");
+        return 1;
+    }
+    *((memaddr *) RAMBASEADDR) = RAMSTART;
+    *((memaddr *) RAMBASESIZE) = FAKERAMSIZE;
+
+    testSlabs();
+    testQueues();
+    testTrees();
+
+    if (failures > 0) {
+        printf("pcbTest: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("pcbTest: ok\n");
+    return 0;
+}
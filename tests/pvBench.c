@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include <sys/mman.h>
+#undef NULL
+
+#include "../h/exceptions.h"
+
+/*****************************************************************************
+ *  Nucleus P/V Host Benchmark
+ *
+ *  Runs the nucleus (exceptions.c, scheduler.c, interrupts.c, asl.c and
+ *  pcb.c) on the build host and times the SYS3/SYS4 paths as a U-proc
+ *  sees them, from the SYSCALL exception to the LDST that resumes a
+ *  process:
+ *  - P/V pair: one process does a P that does not block and a V that
+ *    wakes nobody, so it is resumed straight after each;
+ *  - ping-pong: two processes pass a token back and forth through two
+ *    semaphores, so every round has two blocking Ps, two waking Vs and
+ *    two process switches.
+ *  Each is repeated ROUNDS times and reported in nanoseconds, and in TSC
+ *  cycles on x86 hosts, per P/V pair or per round.
+ *
+ *  The uMPS3 library calls are stubbed out. LDST saves the state being
+ *  loaded and longjmps back to the benchmark, which plays the process
+ *  that is now current: it copies that state to the BIOS data page, as
+ *  the processor does on an exception, puts the next syscall of the
+ *  process in a0 and a1, and enters exceptionHandler. The BIOS data page,
+ *  the bus registers and RAM are mapped at their uMPS3 addresses, and the
+ *  semaphores live in RAM, since syscall arguments are 32-bit registers.
+ *  The TOD clock stands still, so no slice ever runs out and no interrupt
+ *  is taken. Exits with status 1 if a process is resumed out of turn.
+ *
+ *  Written by Khoa Ho & Hieu Tran
+ */
+
+#define ROUNDS      1000000  /* P/V pairs, and ping-pong rounds, timed */
+#define FAKERAMSIZE 0x80000  /* RAM mapped at RAMSTART */
+
+/* The nucleus globals, which initial.c defines in the kernel */
+int processCount;
+int softBlockCount;
+pcb_PTR readyQueues[MLFQLEVELS];
+pcb_PTR currentProcess;
+int deviceSemaphores[DEVICE_COUNT];
+pcb_PTR deviceQueues[DEVICE_COUNT];
+cpu_t TOD_start;
+
+HIDDEN jmp_buf resumed;    /* where LDST returns to */
+HIDDEN state_t loaded;     /* the state LDST last loaded */
+HIDDEN int *sems;          /* the benchmark's semaphores, in RAM */
+HIDDEN int steps[2];       /* syscalls issued by each process */
+HIDDEN pcb_PTR procs[2];
+HIDDEN int errors = 0;
+HIDDEN struct timespec start;         /* when the timed calls started */
+HIDDEN unsigned long long startCycles;
+
+/*****************************************************************************
+ * Stubs of the uMPS3 library
+ */
+void LDST(void *state) {
+    memcpy(&loaded, state, sizeof(state_t));
+    longjmp(resumed, 1);
+}
+unsigned int setTIMER(unsigned int t) { return t; }
+unsigned int getTIMER(void) { return 0; }
+unsigned int setSTATUS(unsigned int s) { return s; }
+unsigned int getSTATUS(void) { return 0; }
+unsigned int getCAUSE(void) { return 0; }
+unsigned int setENTRYHI(unsigned int e) { return e; }
+unsigned int setENTRYLO(unsigned int e) { return e; }
+unsigned int getENTRYHI(void) { return 0; }
+void TLBWR(void) {}
+void TLBCLR(void) {}
+void LDCXT(unsigned int sp, unsigned int status, unsigned int pc) { abort(); }
+void WAIT(void) { printf("pvBench: the nucleus waited\n"); exit(1); }
+void HALT(void) { printf("pvBench: the nucleus halted\n"); exit(1); }
+void PANIC(void) { printf("pvBench: the nucleus panicked\n"); exit(1); }
+
+/*****************************************************************************
+ * Helper function: mapAt
+ * Maps size bytes of zeroed memory at addr. Returns FALSE if addr is not
+ * free on this host.
+ */
+HIDDEN int mapAt(memaddr addr, unsigned int size) {
+    void *p = mmap((void *) (unsigned long) addr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == (void *) (unsigned long) addr;
+}
+
+/*****************************************************************************
+ * Helper function: cycles
+ * Returns the TSC on x86 hosts, and 0 elsewhere.
+ */
+HIDDEN unsigned long long cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*****************************************************************************
+ * Helper function: syscall
+ * Raises a SYSCALL exception for the current process, whose registers are
+ * the state last loaded, and enters the nucleus. Does not return.
+ */
+HIDDEN void syscall(int code, int *semAdd) {
+    state_PTR excState = (state_PTR) BIOSDATAPAGE;
+    memcpy(excState, &loaded, sizeof(state_t));
+    excState->s_a0 = code;
+    excState->s_a1 = (memaddr) (unsigned long) semAdd;
+    excState->s_a2 = FALSE;
+    excState->s_cause = SYSCALL_EXCEPTION << CAUSE_EXCCODE_SHIFT;
+    exceptionHandler();
+}
+
+/*****************************************************************************
+ * Helper function: newProcess
+ * Allocates a ready process that runs in kernel mode.
+ */
+HIDDEN pcb_PTR newProcess() {
+    pcb_PTR p = allocPcb();
+    p->p_s.s_status = ALLOFF | IEPON | IMON | TEBITON;
+    readyProcess(p);
+    processCount++;
+    return p;
+}
+
+/*****************************************************************************
+ * Helper function: report
+ * Prints the time per call of the n calls timed since start.
+ */
+HIDDEN void report(char *what, int n) {
+    unsigned long long used = cycles() - startCycles;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / n;
+    printf("%-10s %10.1f %12.1f\n", what, ns, (double) used / n);
+}
+
+int main() {
+    if (!mapAt(BIOSDATAPAGE, PAGESIZE) || !mapAt(RAMBASEADDR, PAGESIZE) ||
+        !mapAt(RAMSTART, FAKERAMSIZE)) {
+        printf("pvBench: cannot map the uMPS3 memory layout on this host\n");
+        return 1;
+    }
+    *((memaddr *) RAMBASEADDR) = RAMSTART;
+    *((memaddr *) RAMBASESIZE) = FAKERAMSIZE;
+    *((memaddr *) TIMESCALEADDR) = 1;
+    sems = (int *) (unsigned long) RAMSTART;
+
+    int i;
+    initPcbs();
+    initASL();
+    for (i = 0; i < MLFQLEVELS; i++) {
+        readyQueues[i] = mkEmptyProcQ();
+    }
+    for (i = 0; i < DEVICE_COUNT; i++) {
+        deviceQueues[i] = mkEmptyProcQ();
+    }
+    startClock();
+    currentProcess = NULL;
+
+    printf("%-10s %10s %12s\n", "", "ns", "cycles");
+
+    /* P/V pair: sems[0] starts at 1, so P never blocks */
+    sems[0] = 1;
+    procs[0] = newProcess();
+    if (!setjmp(resumed)) {
+        scheduler();
+    }
+    if (steps[0] == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        startCycles = cycles();
+    }
+    if (currentProcess != procs[0]) {
+        errors++;
+    }
+    if (steps[0] < 2 * ROUNDS) {
+        steps[0]++;
+        syscall((steps[0] & 1) ? PASSEREN : VERHOGEN, &sems[0]);
+    }
+    report("P/V pair", ROUNDS);
+
+    /* Ping-pong: procs[0] does V(sems[1]) P(sems[2]), and procs[1] does
+       P(sems[1]) V(sems[2]), so they take turns. procs[0] is running. */
+    procs[1] = newProcess();
+    steps[0] = 0;
+    setjmp(resumed);
+    if (steps[0] == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        startCycles = cycles();
+    }
+    int who = (currentProcess == procs[1]);
+    if (currentProcess != procs[who] || abs(steps[0] - steps[1]) > 2) {
+        errors++;
+    }
+    if (steps[0] < 2 * ROUNDS) {
+        steps[who]++;
+        if (who == 0) {
+            syscall((steps[0] & 1) ? VERHOGEN : PASSEREN, (steps[0] & 1) ? &sems[1] : &sems[2]);
+        }
+        syscall((steps[1] & 1) ? PASSEREN : VERHOGEN, (steps[1] & 1) ? &sems[1] : &sems[2]);
+    }
+    report("ping-pong", ROUNDS);
+
+    if (errors > 0) {
+        printf("pvBench: %d processes resumed out of turn\n", errors);
+        return 1;
+    }
+    return 0;
+}